@@ -0,0 +1,137 @@
+/*
+
+  acquisition.cpp - Linux host program using i2c_adc_ads7828 library
+
+  Benchmarks ADS7828Acquisition against simulated buses (no hardware):
+  each bus carries one ADS7828 whose channels return fixed levels, and each
+  I2C_RDWR ioctl takes as long as the transfer would at 400 kHz. Samples
+  per second should scale with the quantity of buses.
+
+  Built and run with the other host programs by: make linux
+
+  Library:: i2c_adc_ads7828
+  Author:: Doc Walker <4-20ma@wvfans.net>
+
+  Copyright:: 2009-2016 Doc Walker
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+*/
+
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <chrono>
+#include <i2c_adc_ads7828.h>
+#include <i2c_adc_ads7828_acquisition.h>
+
+
+// simulated adapter with one ADS7828 at address 0 (0x48)
+class SimulatedBus : public ADS7828LinuxIo
+{
+  public:
+    int open(const char*, int) { return 3; }
+    int close(int) { return 0; }
+    int ioctl(int, unsigned long request, void* arg)
+    {
+      if (I2C_RDWR != request) return -1;
+      struct i2c_rdwr_ioctl_data* data = (struct i2c_rdwr_ioctl_data*) arg;
+      uint32_t bits = 0;
+      for (uint32_t k = 0; k < data->nmsgs; k++)
+      {
+        struct i2c_msg* msg = &data->msgs[k];
+        bits += 9 * (1 + msg->len) + 2; // address + data bytes, START/STOP
+        if (0x48 != msg->addr)
+        {
+          errno = ENXIO;
+          return -1;
+        }
+        if (msg->flags & I2C_M_RD)
+        {
+          uint16_t value = level(command_);
+          msg->buf[0] = value >> 8;
+          msg->buf[1] = value & 0xFF;
+        }
+        else if (msg->len > 0)
+        {
+          command_ = msg->buf[0];
+        }
+      }
+      usleep(bits * 1000000UL / I2C_FAST_MODE);
+      return 0;
+    }
+
+    // channel n (ID bits 0, 1, 2 in command bits 6, 4, 5) reads 100 * (n + 1)
+    static uint16_t level(uint8_t command)
+    {
+      uint8_t id = ((command >> 6) & 1) | ((command >> 3) & 2) |
+        ((command >> 3) & 4);
+      return 100 * (id + 1);
+    }
+
+  private:
+    uint8_t command_;
+};
+
+
+int main()
+{
+  int failures = 0;
+  for (uint8_t buses = 1; buses <= 4; buses *= 2)
+  {
+    SimulatedBus adapter[4];
+    TwoWire wire[4];
+    ADS7828* device[4];
+    ADS7828Acquisition acquisition;
+    for (uint8_t b = 0; b < buses; b++)
+    {
+      wire[b].setIo(&adapter[b]);
+      wire[b].begin("/dev/i2c-simulated");
+      device[b] = new ADS7828(0, SINGLE_ENDED | REFERENCE_ON | ADC_ON);
+      acquisition.addDevice(acquisition.addBus(&wire[b]), device[b]);
+    }
+
+    acquisition.start(0);
+    uint32_t samples = 0;
+    std::chrono::steady_clock::time_point started =
+      std::chrono::steady_clock::now();
+    ADS7828Sample sample;
+    while (std::chrono::steady_clock::now() - started <
+      std::chrono::seconds(1))
+    {
+      for (uint8_t b = 0; b < buses; b++)
+      {
+        while (acquisition.queue(b)->pop(sample))
+        {
+          if (100 * (sample.channel + 1) != sample.value) failures++;
+          samples++;
+        }
+      }
+    }
+    acquisition.stop();
+
+    uint32_t errors = 0, dropped = 0;
+    for (uint8_t b = 0; b < buses; b++)
+    {
+      errors += acquisition.errors(b);
+      dropped += acquisition.dropped(b);
+      delete device[b];
+    }
+    printf("%u bus(es): %u samples/s, %u errors, %u dropped\n", buses,
+      samples, errors, dropped);
+  }
+
+  if (failures > 0) printf("%d samples with unexpected value\n", failures);
+  return failures > 0;
+}
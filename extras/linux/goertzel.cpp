@@ -0,0 +1,78 @@
+/*
+
+  goertzel.cpp - Linux host program using i2c_adc_ads7828 library
+
+  Validates ADS7828Goertzel with synthetic sines (no hardware): a channel
+  sampled at 1000 samples/s is fed a mid-scale offset, 800-count 50 Hz and
+  300-count 120 Hz tones, and +/-10 counts of noise. Detectors at the two
+  tones should report their amplitudes; detectors at 60 Hz, 200 Hz, and
+  1 Hz (lowest bin, next to DC) should report approximately 0.
+
+  Built and run with the other host programs by: make linux
+
+  Library:: i2c_adc_ads7828
+  Author:: Doc Walker <4-20ma@wvfans.net>
+
+  Copyright:: 2009-2016 Doc Walker
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+*/
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <i2c_adc_ads7828.h>
+
+
+const uint16_t SAMPLE_RATE = 1000; // samples/s
+const uint16_t BLOCK_SIZE = 200;   // 5 Hz bins
+
+
+ADS7828 device(0, SINGLE_ENDED | REFERENCE_ON | ADC_ON);
+ADS7828Channel* ripple = device.channel(0);
+
+
+int main()
+{
+  const uint16_t frequency[] = { 50, 120, 60, 200, 1 };
+  const uint16_t expected[] = { 800, 300, 0, 0, 0 };
+  const uint8_t detectors = sizeof(frequency) / sizeof(frequency[0]);
+  ADS7828Goertzel* goertzel[detectors];
+  for (uint8_t k = 0; k < detectors; k++)
+  {
+    goertzel[k] = new ADS7828Goertzel(frequency[k], SAMPLE_RATE, BLOCK_SIZE);
+    ripple->attach(goertzel[k]);
+  }
+
+  for (uint32_t n = 0; n < 5 * BLOCK_SIZE; n++)
+  {
+    double t = (double) n / SAMPLE_RATE;
+    double v = 2047 + 800 * sin(2 * M_PI * 50 * t + 1) +
+      300 * sin(2 * M_PI * 120 * t) + (rand() % 21 - 10);
+    ripple->newSample((uint16_t) lround(v));
+  }
+
+  int failures = 0;
+  for (uint8_t k = 0; k < detectors; k++)
+  {
+    uint16_t magnitude = goertzel[k]->magnitude();
+    int error = (int) magnitude - expected[k];
+    bool pass = abs(error) <= 5;
+    printf("%4u Hz: %4u (expected %4u) %s\n", frequency[k], magnitude,
+      expected[k], pass ? "ok" : "FAIL");
+    if (!pass) failures++;
+  }
+  return failures > 0;
+}
@@ -0,0 +1,233 @@
+/*
+
+  telemetry.cpp - Linux host program using i2c_adc_ads7828 library
+
+  Benchmarks ADS7828Encoder / ADS7828Decoder (no hardware required). Each
+  sweep of samples is encoded into one frame, which is decoded and compared
+  with the encoded samples; a dropped frame must resynchronize at the next
+  key frame and a corrupted frame must fail its CRC. Reports mean frame
+  size, compression ratio versus 16-bit raw samples, and encode time.
+
+  telemetry             synthetic samples: two devices (8 + 4 channels)
+                        carry slowly-varying sines with noise
+  telemetry trace.bin   samples of a trace written by ADS7828::record()
+                        (device-major scan order), replayed through
+                        ADS7828Replay and ADS7828::updateAll()
+
+  Built and run (synthetic samples) with the other host programs by:
+  make linux
+
+  Library:: i2c_adc_ads7828
+  Author:: Doc Walker <4-20ma@wvfans.net>
+
+  Copyright:: 2009-2016 Doc Walker
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+*/
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#include <i2c_adc_ads7828.h>
+
+
+const uint32_t SYNTHETIC_FRAMES = 100000;
+const uint32_t DROPPED_FRAME = 40;
+const uint8_t KEY_INTERVAL = 32;
+
+
+ADS7828Replay replay;
+bool replaying = false;
+uint32_t synthesized = 0;
+
+
+// register devices for synthetic samples
+void synthesize()
+{
+  new ADS7828(0, SINGLE_ENDED | REFERENCE_ON | ADC_ON);
+  new ADS7828(1, SINGLE_ENDED | REFERENCE_ON | ADC_ON, 0x0F);
+}
+
+
+// register devices/channel masks found in trace and replay it via Wire
+bool load(const char* path)
+{
+  FILE* file = fopen(path, "rb");
+  if (0 == file) return false;
+  std::vector<uint8_t> trace;
+  int c;
+  while (EOF != (c = fgetc(file))) trace.push_back(c);
+  fclose(file);
+
+  // record layout documented at ADS7828::record()
+  uint8_t masks[4] = { 0 }, options[4] = { 0 };
+  bool probed = false;
+  size_t k = 0;
+  while (k + 4 <= trace.size())
+  {
+    uint8_t tag = trace[k];
+    if (tag & 0x80)
+    {
+      k += 5; // result record
+      continue;
+    }
+    if (tag & 0x08)
+    {
+      probed = true;
+      k += 3; // probe record
+      continue;
+    }
+    uint8_t command = trace[k + 3], a = tag & 0x03;
+    uint8_t id = ((command >> 6) & 1) | ((command >> 3) & 2) |
+      ((command >> 3) & 4);
+    masks[a] |= 1 << id;
+    options[a] |= command & (SINGLE_ENDED | REFERENCE_ON | ADC_ON);
+    k += 4;
+  }
+  for (uint8_t a = 0; a < 4; a++)
+  {
+    if (0 != masks[a]) new ADS7828(a, options[a], masks[a]);
+  }
+
+  if (!replay.load(path)) return false;
+  Wire.setIo(&replay);
+  ADS7828::begin();
+  if (probed) ADS7828::discover();
+  replaying = true;
+  return true;
+}
+
+
+// take next sweep of samples; false when source is exhausted
+bool sweep()
+{
+  if (replaying)
+  {
+    if (replay.finished()) return false;
+    ADS7828::updateAll();
+    return true;
+  }
+  if (SYNTHETIC_FRAMES == synthesized) return false;
+  uint32_t n = synthesized++;
+  for (uint8_t a = 0; a < 2; a++)
+  {
+    ADS7828* device = ADS7828::device(a);
+    for (uint8_t ch = 0; ch < 8; ch++)
+    {
+      if (!((device->channelMask >> ch) & 1)) continue;
+      double v = 2048 + 1500 * sin(n / 500.0 + 8 * a + ch) + rand() % 9 - 4;
+      device->channel(ch)->newSample((uint16_t) lround(v));
+    }
+  }
+  return true;
+}
+
+
+// return quantity of channels in frame; 0 if decoder differs from samples
+uint8_t matches(ADS7828Decoder* decoder)
+{
+  uint8_t channels = 0;
+  for (uint8_t a = 0; a < 4; a++)
+  {
+    ADS7828* device = ADS7828::device(a);
+    if (0 == device || !device->active()) continue;
+    for (uint8_t ch = 0; ch < 8; ch++)
+    {
+      if (!((device->channelMask >> ch) & 1)) continue;
+      if (decoder->value(a, ch) != device->channel(ch)->sample()) return 0;
+      channels++;
+    }
+  }
+  return channels;
+}
+
+
+int main(int argc, char** argv)
+{
+  if (argc > 1)
+  {
+    if (!load(argv[1]))
+    {
+      printf("cannot load trace %s\n", argv[1]);
+      return 1;
+    }
+  }
+  else
+  {
+    synthesize();
+  }
+
+  ADS7828Encoder encoder(KEY_INTERVAL);
+  ADS7828Decoder decoder;
+  uint8_t frame[ADS7828Encoder::MAX_FRAME_SIZE];
+  uint32_t frames = 0, bytes = 0, raw = 0, decoded = 0, unsynced = 0;
+  uint64_t elapsed = 0;
+  int failures = 0;
+
+  while (sweep())
+  {
+    std::chrono::steady_clock::time_point started =
+      std::chrono::steady_clock::now();
+    uint8_t length = encoder.encodeAll(frame);
+    elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - started).count();
+    bytes += length;
+
+    if (DROPPED_FRAME == frames++) continue; // lost in transit
+    uint8_t status = decoder.decode(frame, length), channels;
+    if (3 == status)
+    {
+      unsynced++; // awaiting key frame
+    }
+    else if (0 != status || 0 == (channels = matches(&decoder)))
+    {
+      failures++;
+    }
+    else
+    {
+      raw += channels * sizeof(uint16_t);
+      decoded++;
+    }
+  }
+
+  uint8_t length = encoder.encodeAll(frame);
+  frame[length / 2] ^= 0x01;
+  if (2 != decoder.decode(frame, length)) failures++;
+
+  if (0 == decoded)
+  {
+    printf("no frames\n");
+    return 1;
+  }
+  printf("frames: %u, mean %.1f bytes (raw %.1f), ratio %.2f\n", frames,
+    (double) bytes / frames, (double) raw / decoded,
+    (double) raw / decoded * frames / bytes);
+  printf("encode: %.0f ns/frame\n", (double) elapsed / frames);
+  printf("frames skipped awaiting key frame after drop: %u\n", unsynced);
+  if (frames > DROPPED_FRAME + KEY_INTERVAL && unsynced >= KEY_INTERVAL)
+  {
+    failures++;
+  }
+  if (replaying && replay.mismatches() > 0)
+  {
+    printf("%u transactions differ from trace (record with "
+      "SCAN_DEVICE_MAJOR)\n", replay.mismatches());
+    failures++;
+  }
+  if (failures > 0) printf("%d failures\n", failures);
+  return failures > 0;
+}
@@ -22,8 +22,102 @@
 */
 
 
+// _________________________________________________________ STANDARD INCLUDES
+#if defined(__AVR__)
+#include <avr/sleep.h>
+#elif !defined(ARDUINO)
+#include <mutex>
+#endif
+
+
 // __________________________________________________________ PROJECT INCLUDES
 #include "i2c_adc_ads7828.h"
+#if !defined(ARDUINO)
+#include "i2c_adc_ads7828_wiring.h"
+#endif
+
+
+// _________________________________________________________ PRIVATE FUNCTIONS
+#if !defined(ARDUINO)
+/// Serializes ADS7828::record() / trace() across ADS7828Acquisition workers.
+static std::mutex traceMutex;
+#endif
+
+
+/// Return integer square root (rounded down).
+/// \param value radicand
+/// \return floor(sqrt(value))
+static uint32_t squareRoot(uint64_t value)
+{
+  uint64_t root = 0, bit = (uint64_t) 1 << 62;
+  while (bit > value) bit >>= 2;
+  while (0 != bit)
+  {
+    if (value >= root + bit)
+    {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+
+/// Return CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF).
+/// \param data bytes
+/// \param length quantity of bytes
+static uint16_t crc16(const uint8_t* data, uint8_t length)
+{
+  uint16_t crc = 0xFFFF;
+  while (length--)
+  {
+    crc ^= (uint16_t) *data++ << 8;
+    for (uint8_t k = 0; k < 8; k++)
+    {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+
+/// Append bit field (MSB first) to zero-initialized buffer.
+/// \param buffer destination
+/// \param position bit position within buffer; advanced by width
+/// \param value field value
+/// \param width field width (0..16 bits)
+static void putBits(uint8_t* buffer, uint16_t& position, uint16_t value,
+  uint8_t width)
+{
+  while (width--)
+  {
+    if (bitRead(value, width)) buffer[position >> 3] |= 0x80 >> (position & 7);
+    position++;
+  }
+}
+
+
+/// Extract bit field (MSB first) from buffer.
+/// \param buffer source
+/// \param position bit position within buffer; advanced by width
+/// \param width field width (0..16 bits)
+/// \return field value
+static uint16_t getBits(const uint8_t* buffer, uint16_t& position,
+  uint8_t width)
+{
+  uint16_t value = 0;
+  while (width--)
+  {
+    value = (value << 1) | ((buffer[position >> 3] >> (7 - (position & 7))) & 1);
+    position++;
+  }
+  return value;
+}
 
 
 // ___________________________________________________ PUBLIC MEMBER FUNCTIONS
@@ -32,15 +126,40 @@
 ADS7828Channel::ADS7828Channel(ADS7828* const device, uint8_t id,
   uint8_t options, uint16_t min, uint16_t max)
 {
+  this->accumulators_ = 0;
   this->device_ = device;
   this->commandByte_ = (bitRead(options, 7) << 7) | (bitRead(id, 0) << 6) |
     (bitRead(id, 2) << 5) | (bitRead(id, 1) << 4);
+  this->maxAge = 0;
   this->minScale = min;
   this->maxScale = max;
   reset();
 }
 
 
+/// Attach accumulator to be fed each new (unscaled) sample.
+/// An accumulator that is already attached (to this or another channel) is
+///   ignored; detach() it first to move it.
+/// \param accumulator accumulator object
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0);
+/// ADS7828Rms mains(200);
+/// ...
+/// adc.channel(0)->attach(&mains);
+/// ...
+/// \endcode
+/// \sa ADS7828Channel::detach()
+void ADS7828Channel::attach(ADS7828Accumulator* accumulator)
+{
+  if (0 != accumulator->channel_) return; // already attached
+  accumulator->channel_ = this;
+  accumulator->next_ = accumulators_;
+  this->accumulators_ = accumulator;
+}
+
+
 /// Return command byte for channel object.
 /// \optional This function is for testing and troubleshooting.
 /// \return command byte (0x00..0xFC)
@@ -58,6 +177,25 @@ uint8_t ADS7828Channel::commandByte()
 }
 
 
+/// Detach accumulator previously attached via attach().
+/// \param accumulator accumulator object
+/// \par Usage:
+/// \code
+/// ...
+/// adc.channel(0)->detach(&mains);
+/// ...
+/// \endcode
+void ADS7828Channel::detach(ADS7828Accumulator* accumulator)
+{
+  if (this != accumulator->channel_) return; // not attached to this channel
+  accumulator->channel_ = 0;
+  ADS7828Accumulator** link = &accumulators_;
+  while (0 != *link && accumulator != *link) link = &(*link)->next_;
+  if (0 != *link) *link = accumulator->next_;
+  accumulator->next_ = 0;
+}
+
+
 /// Return pointer to parent device object.
 /// \return pointer to parent ADS7828 object
 /// \par Usage:
@@ -74,6 +212,25 @@ ADS7828* ADS7828Channel::device()
 }
 
 
+/// Return whether most-recent sample is within freshness window.
+/// \retval true sample taken within \ref maxAge microseconds
+/// \retval false \ref maxAge is 0, no sample since reset(), or sample too old
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0);
+/// ADS7828Channel* temperature = adc.channel(0);
+/// temperature->maxAge = 1000;
+/// if (!temperature->fresh()) temperature->update();
+/// ...
+/// \endcode
+bool ADS7828Channel::fresh()
+{
+  return 0 != maxAge && 0 != timestamp_ &&
+    (uint32_t) micros() - timestamp_ <= maxAge;
+}
+
+
 /// Return ID number of channel object (+IN connection).
 /// Single-ended inputs use COM as -IN; Differential inputs are as follows:
 /// \arg 0 indicates CH0 as +IN, CH1 as -IN
@@ -123,21 +280,60 @@ uint8_t ADS7828Channel::index()
 }
 
 
-/// Add (unscaled) sample value to moving average array, update totalizer.
+/// Add (unscaled) sample value to moving average array, update totalizer,
+///   feed attached accumulators.
 /// \param sample sample value (0x0000..0xFFFF)
 /// \remark Invoked by ADS7828::update() / ADS7828::updateAll() functions;
 ///   this function will not normally be called by end user.
 void ADS7828Channel::newSample(uint16_t sample)
 {
-  this->index_++;
-  if (index_ >= (1 << MOVING_AVERAGE_BITS_)) this->index_ = 0;
-  this->total_ -= samples_[index_];
-  this->samples_[index_] = sample;
-  this->total_ += samples_[index_];
+  this->timestamp_ = micros();
+  if (primed_)
+  {
+    this->index_++;
+    if (index_ >= (1 << MOVING_AVERAGE_BITS_)) this->index_ = 0;
+    this->total_ -= samples_[index_];
+    this->samples_[index_] = sample;
+    this->total_ += samples_[index_];
+  }
+  else
+  {
+    prime(sample);
+  }
+  for (ADS7828Accumulator* a = accumulators_; 0 != a; a = a->next_)
+  {
+    a->newSample(sample);
+  }
+}
+
+
+/// Fill moving average array with (unscaled) sample value, update totalizer.
+/// value() reflects the sample immediately rather than ramping up from zero
+///   over the first 2<sup>\ref MOVING_AVERAGE_BITS_</sup> samples.
+/// \param sample sample value (0x0000..0x0FFF)
+/// \remark Invoked by newSample() for the first sample following reset().
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0);
+/// ADS7828Channel* temperature = adc.channel(0);
+/// temperature->prime(2048); // seed with a known mid-scale value
+/// ...
+/// \endcode
+void ADS7828Channel::prime(uint16_t sample)
+{
+  for (uint8_t k = 0; k < (1 << MOVING_AVERAGE_BITS_); k++)
+  {
+    this->samples_[k] = sample;
+  }
+  this->index_ = 0;
+  this->total_ = sample << MOVING_AVERAGE_BITS_;
+  this->primed_ = true;
 }
 
 
 /// Reset moving average array, index, totalizer to zero.
+/// The next sample primes the entire moving average array.
 /// \par Usage:
 /// \code
 /// ...
@@ -146,6 +342,7 @@ void ADS7828Channel::newSample(uint16_t sample)
 /// temperature->reset();
 /// ...
 /// \endcode
+/// \sa ADS7828Channel::prime()
 void ADS7828Channel::reset()
 {
   this->index_ = this->total_ = 0;
@@ -153,6 +350,57 @@ void ADS7828Channel::reset()
   {
     this->samples_[k] = 0;
   }
+  this->primed_ = false;
+  this->timestamp_ = 0;
+}
+
+
+/// Restore moving average array, index, totalizer from buffer.
+/// Use with snapshot() to carry filter state across deep sleep
+///   (e.g. EEPROM or RTC memory) instead of re-priming after wake.
+/// A buffer that could not have been written by snapshot() (e.g. blank
+///   EEPROM, or a sample above 0x0FFF) is rejected and the channel is
+///   reset() so the next sample primes the moving average.
+/// \param buffer source of \ref SNAPSHOT_SIZE bytes written by snapshot()
+/// \return quantity of bytes read (\ref SNAPSHOT_SIZE), or 0 if buffer is
+///   invalid
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0);
+/// ADS7828Channel* temperature = adc.channel(0);
+/// uint8_t state[ADS7828Channel::SNAPSHOT_SIZE];
+/// for (uint8_t k = 0; k < sizeof(state); k++) state[k] = EEPROM.read(k);
+/// if (0 == temperature->restore(state))
+/// {
+///   // no saved state; first conversion primes moving average
+/// }
+/// ...
+/// \endcode
+/// \sa ADS7828Channel::snapshot()
+uint8_t ADS7828Channel::restore(const uint8_t* buffer)
+{
+  uint8_t k;
+  bool valid = 0 == (buffer[0] & 0x70); // bits 6..4 unused by snapshot()
+  for (k = 0; k < (1 << MOVING_AVERAGE_BITS_); k++)
+  {
+    if (buffer[2 * k + 2] > 0x0F) valid = false; // sample above 12 bits
+  }
+  if (!valid)
+  {
+    reset();
+    return 0;
+  }
+
+  this->index_ = buffer[0] & ((1 << MOVING_AVERAGE_BITS_) - 1);
+  this->primed_ = bitRead(buffer[0], 7);
+  this->total_ = 0;
+  for (k = 0; k < (1 << MOVING_AVERAGE_BITS_); k++)
+  {
+    this->samples_[k] = word(buffer[2 * k + 2], buffer[2 * k + 1]);
+    this->total_ += samples_[k];
+  }
+  return SNAPSHOT_SIZE;
 }
 
 
@@ -173,6 +421,32 @@ uint16_t ADS7828Channel::sample()
 }
 
 
+/// Copy moving average array and index to buffer.
+/// \param buffer destination of \ref SNAPSHOT_SIZE bytes
+/// \return quantity of bytes written (\ref SNAPSHOT_SIZE)
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0);
+/// ADS7828Channel* temperature = adc.channel(0);
+/// uint8_t state[ADS7828Channel::SNAPSHOT_SIZE];
+/// temperature->snapshot(state);
+/// for (uint8_t k = 0; k < sizeof(state); k++) EEPROM.update(k, state[k]);
+/// ...
+/// \endcode
+/// \sa ADS7828Channel::restore()
+uint8_t ADS7828Channel::snapshot(uint8_t* buffer)
+{
+  buffer[0] = index_ | (primed_ << 7);
+  for (uint8_t k = 0; k < (1 << MOVING_AVERAGE_BITS_); k++)
+  {
+    buffer[2 * k + 1] = lowByte(samples_[k]);
+    buffer[2 * k + 2] = highByte(samples_[k]);
+  }
+  return SNAPSHOT_SIZE;
+}
+
+
 /// Initiate A/D conversion for channel object.
 /// \optional This function is for testing and troubleshooting.
 /// \todo Determine whether this function is needed.
@@ -195,6 +469,24 @@ uint8_t ADS7828Channel::start()
 }
 
 
+/// Return time at which most-recent sample was taken.
+/// \return micros() at time of sample (0 if none since reset())
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0);
+/// ADS7828Channel* voltage = adc.channel(0);
+/// ADS7828Channel* current = adc.channel(1);
+/// ...
+/// uint32_t lag = current->timestamp() - voltage->timestamp();
+/// ...
+/// \endcode
+uint32_t ADS7828Channel::timestamp()
+{
+  return timestamp_;
+}
+
+
 /// Return (unscaled) totalizer value for channel object.
 /// \optional This function is for testing and troubleshooting.
 /// \return totalizer value (0x0000..0xFFFF)
@@ -213,6 +505,8 @@ uint16_t ADS7828Channel::total()
 
 
 /// Initiate A/D conversion, read data, update moving average for channel object.
+/// A request within the freshness window (\ref maxAge) is served from the
+///   most-recent sample without a bus transaction.
 /// \optional This function is for testing and troubleshooting.
 /// \todo Determine whether this function is needed.
 /// \retval 0 success
@@ -230,7 +524,7 @@ uint16_t ADS7828Channel::total()
 /// \endcode
 uint8_t ADS7828Channel::update()
 {
-  device_->update(id());
+  return device_->update(id());
 }
 
 
@@ -350,6 +644,26 @@ ADS7828::ADS7828(uint8_t address, uint8_t options, uint8_t channelMask,
 }
 
 
+/// Return whether device acknowledged during most-recent discover().
+/// Devices are active when constructed; discover() marks devices that
+///   are not on the bus inactive so updateAll() skips them.
+/// \retval true device present (or discover() not called)
+/// \retval false device did not acknowledge its address
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(3);
+/// ADS7828::discover();
+/// if (!adc.active()) Serial.print("ADS7828 #3 not found");
+/// ...
+/// \endcode
+/// \sa ADS7828::discover()
+bool ADS7828::active()
+{
+  return active_;
+}
+
+
 /// Device address as defined by pins A1, A0
 /// \retval 0x00 A1=0, A0=0
 /// \retval 0x01 A1=0, A0=1
@@ -403,6 +717,42 @@ uint8_t ADS7828::commandByte()
 }
 
 
+/// Return quantity of update(uint8_t) requests served from a fresh sample.
+/// \optional This function is for tuning ADS7828Channel::maxAge.
+/// \return quantity of cache hits since construction
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0);
+/// ...
+/// uint32_t saved = adc.hits(); // bus transactions avoided
+/// ...
+/// \endcode
+/// \sa ADS7828::misses()
+uint32_t ADS7828::hits()
+{
+  return hits_;
+}
+
+
+/// Return quantity of update(uint8_t) requests that required a conversion.
+/// \optional This function is for tuning ADS7828Channel::maxAge.
+/// \return quantity of cache misses since construction
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0);
+/// ...
+/// uint32_t ratio = 100 * adc.hits() / (adc.hits() + adc.misses());
+/// ...
+/// \endcode
+/// \sa ADS7828::hits()
+uint32_t ADS7828::misses()
+{
+  return misses_;
+}
+
+
 /// Initiate communication with device.
 /// \optional This function is for testing and troubleshooting and
 ///   can be used to determine whether a device is available (similar to
@@ -444,7 +794,7 @@ uint8_t ADS7828::start()
 /// \endcode
 uint8_t ADS7828::start(uint8_t ch)
 {
-  return start(address_, commandByte_ | channel(ch)->commandByte());
+  return start(bus, address_, commandByte_ | channel(ch)->commandByte());
 }
 
 
@@ -468,13 +818,19 @@ uint8_t ADS7828::start(uint8_t ch)
 /// \endcode
 uint8_t ADS7828::update()
 {
-  return update(this);
+  beginSweep();
+  uint8_t count = update(this);
+  endSweep(count > 0);
+  return count;
 }
 
 
 /// \overload uint8_t ADS7828::update(uint8_t ch)
 /// \required Call this or one of the update() / updateAll() functions
 ///   from within \c loop() in order to read data from device(s).
+/// \note If the channel's most-recent sample is within its freshness
+///   window (ADS7828Channel::maxAge), no conversion is performed and the
+///   moving average is left unchanged.
 /// \param ch channel number (0..7)
 /// \retval 0 success
 /// \retval 1 length too long for buffer
@@ -497,115 +853,765 @@ uint8_t ADS7828::update()
 /// \endcode
 uint8_t ADS7828::update(uint8_t ch)
 {
-  return update(this, ch);
+  if (channel(ch)->fresh())
+  {
+    hits_++;
+    return 0;
+  }
+  misses_++;
+  beginSweep();
+  uint8_t status = update(this, ch);
+  endSweep(0 == status);
+  return status;
 }
 
 
 // ____________________________________________ STATIC PUBLIC MEMBER FUNCTIONS
-/// Enable I2C communication.
-/// \required Call from within \c setup()\c to enable I2C communication.
+/// Sleep until next scheduled sweep, then update all unmasked channels on
+///   all active registered devices (see updateAll()).
+/// The MCU sleeps between sweeps (AVR idle mode, wait-for-interrupt on
+///   ARM Arduino cores, \c delay() elsewhere) and is woken by the timer
+///   tick behind \c millis(), i.e. about 1000 times per second; a function
+///   installed by sleepHook() may sleep longer. Each device is fully
+///   powered down (PD1 = PD0 = 0) by the command byte of its last unmasked
+///   channel.
+/// \required Call lowPower() from within \c setup()\c to schedule sweeps;
+///   otherwise acquire() sweeps immediately, like updateAll().
+/// \return quantity of channels updated (0..32)
 /// \par Usage:
 /// \code
 /// ...
 /// void setup()
 /// {
-///   // enable I2C communication
 ///   ADS7828::begin();
+///   // one sweep per second
+///   ADS7828::lowPower(1000);
+/// }
+///
+/// void loop()
+/// {
+///   // sleeps until next sweep is due
+///   ADS7828::acquire();
+///   ...
 /// }
 /// ...
 /// \endcode
-void ADS7828::begin()
+/// \sa ADS7828::awakeTime(), ADS7828::conversionsPerWake(),
+///   ADS7828::pollTime(), ADS7828::wakes()
+uint8_t ADS7828::acquire()
 {
-  Wire.begin();
+  wakes_ = 0;
+  pollTime_ = 0;
+  if (0 != interval_)
+  {
+    int32_t remaining;
+    uint32_t polled = micros();
+    while ((remaining = (int32_t) (scheduled_ - millis())) > 0)
+    {
+      pollTime_ += micros() - polled;
+      if (0 != sleepHook_)
+      {
+        sleepHook_(remaining);
+      }
+      else
+      {
+        sleep();
+      }
+      wakes_++;
+      polled = micros();
+    }
+    pollTime_ += micros() - polled;
+    scheduled_ += interval_;
+    if ((int32_t) (millis() - scheduled_) >= 0)
+    {
+      scheduled_ = millis() + interval_; // overran interval; do not catch up
+    }
+  }
+  uint32_t woke = micros();
+  for (uint8_t a = 0; warmUp_ && a < 4; a++)
+  {
+    ADS7828* device = devices_[a];
+    if (0 == device || !device->active_ || 0 == device->channelMask)
+    {
+      continue;
+    }
+    uint8_t ch = 0;
+    while (!bitRead(device->channelMask, ch)) ch++;
+    // conversion is discarded; it powers up reference and A/D converter
+    if (0 == start(device->bus, device->address_,
+      device->channel(ch)->commandByte()))
+    {
+      read(device->bus, device->address_);
+    }
+  }
+  wakeConversions_ = updateAll();
+  awakeTime_ = micros() - woke;
+  if (wakeConversions_ > 0) awakeTime_ /= wakeConversions_;
+  return wakeConversions_;
 }
 
 
-/// Return pointer to device object.
-/// \param address device address (0..3)
-/// \return pointer to ADS7828 object
+/// Return awake time per conversion during most-recent acquire().
+/// Includes any wake-up conversions (see lowPower(uint32_t, bool)), but
+///   not the wake-ups while waiting for the sweep (see pollTime()).
+/// \optional This function is for testing and troubleshooting.
+/// \return awake time per conversion (microseconds); entire awake time if
+///   no conversion succeeded
 /// \par Usage:
 /// \code
 /// ...
-/// // device 2 pointer
-/// ADS7828* device2 = ADS7828::device(2);
+/// ADS7828::acquire();
+/// uint32_t perSample = ADS7828::awakeTime();
 /// ...
 /// \endcode
-ADS7828* ADS7828::device(uint8_t address)
+uint32_t ADS7828::awakeTime()
 {
-  return devices_[address & 0x03];
+  return awakeTime_;
 }
 
 
-/// Update all unmasked channels on all registered devices.
-/// \required Call this or one of the update() functions
-///   from within \c loop() in order to read data from device(s).
-///   This is the most commonly-used device update function.
-/// \return quantity of channels updated (0..32)
+/// Enable I2C communication.
+/// \required Call from within \c setup()\c to enable I2C communication.
 /// \par Usage:
 /// \code
 /// ...
-/// void loop()
+/// void setup()
 /// {
-///   ...
-///   // update all registered ADS7828 devices/unmasked channels
-///   uint8_t quantity = ADS7828::updateAll();
-///   ...
+///   // enable I2C communication
+///   ADS7828::begin();
 /// }
 /// ...
 /// \endcode
-uint8_t ADS7828::updateAll()
+void ADS7828::begin()
 {
-  uint8_t a, ch, count = 0;
-  for (a = 0; a < 4; a++)
-  {
-    if (0 != devices_[a]) count += update(devices_[a]);
-  }
-  return count;
+  Wire.begin();
 }
 
 
-// __________________________________________________ PRIVATE MEMBER FUNCTIONS
-/// Common code for constructors.
-/// \param address device address (0..3)
-/// \param options command byte bits SD, PD1, PD0
-/// \param channelMask bit positions containing a 1 represent channels that
-///   are to be read via update() / updateAll()
-/// \param min minimum scaling value applied to value()
-/// \param max maximum scaling value applied to value()
-void ADS7828::init(uint8_t address, uint8_t options,
-  uint8_t channelMask, uint16_t min, uint16_t max)
+/// \overload void ADS7828::begin(uint32_t clock)
+/// \param clock bus clock (Hz), e.g. \ref I2C_STANDARD_MODE,
+///   \ref I2C_FAST_MODE, \ref I2C_HIGH_SPEED_MODE
+/// \note High-speed mode is entered (master code at fast-mode clock) at the
+///   start of each update() / updateAll() and held across the sweep via
+///   repeated START conditions. This relies on the core's Wire library
+///   holding the bus after the (never acknowledged) master code and
+///   accepting \c setClock() between repeated STARTs, neither of which the
+///   generic Wire API guarantees. It is therefore not available on AVR,
+///   ESP8266, ESP32, SAMD, Teensy, or Linux (fast mode is used instead);
+///   elsewhere begin() verifies it once by probing all device addresses in
+///   high-speed mode and falls back to fast mode if none acknowledges.
+/// \par Usage:
+/// \code
+/// ...
+/// void setup()
+/// {
+///   // enable I2C communication at 400 kHz
+///   ADS7828::begin(I2C_FAST_MODE);
+/// }
+/// ...
+/// \endcode
+/// \sa ADS7828::busClock()
+void ADS7828::begin(uint32_t clock)
 {
-  this->address_ = address & 0x03;     // A1 A0 bits
-  this->commandByte_ = options & 0x0C; // PD1 PD0 bits
-  this->channelMask = channelMask;
-  for (uint8_t ch = 0; ch < 8; ch++)
+  Wire.begin();
+#if defined(__AVR__) || defined(ESP8266) || !defined(ARDUINO)
+  // TWI bit-rate generator / software I2C cannot reach high-speed mode;
+  //   Linux adapter clock is fixed by the kernel driver
+  if (clock > I2C_FAST_MODE) clock = I2C_FAST_MODE;
+#elif defined(ESP32) || defined(ARDUINO_ARCH_SAMD) || defined(TEENSYDUINO)
+  // Wire issues STOP on NACK and reinitializes peripheral in setClock()
+  if (clock > I2C_FAST_MODE) clock = I2C_FAST_MODE;
+#endif
+  clock_ = clock;
+  Wire.setClock(clock > I2C_FAST_MODE ? I2C_FAST_MODE : clock);
+  if (clock_ <= I2C_FAST_MODE) return;
+
+  // verify high-speed entry once rather than losing the first live sweep
+  uint8_t a, present = 0;
+  beginSweep();
+  for (a = 0; a < 4; a++)
   {
-    channels_[ch] = ADS7828Channel(this, ch, options, min, max);
+    Wire.beginTransmission(BASE_ADDRESS_ | a);
+    if (0 == Wire.endTransmission(false)) present++;
   }
-  this->devices_[address_] = this;
+  endSweep(present > 0);
 }
 
 
-/// Request and receive data from most-recent A/D conversion from device.
-/// \return 16-bit zero-padded word (12 data bits D11..D0)
-uint16_t ADS7828::read()
+/// Return bus clock used for update() / updateAll() sweeps.
+/// \optional This function is for testing and troubleshooting.
+/// \return bus clock (Hz); \ref I2C_STANDARD_MODE unless set via begin()
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828::begin(I2C_HIGH_SPEED_MODE);
+/// if (ADS7828::busClock() < I2C_HIGH_SPEED_MODE)
+/// {
+///   // high-speed mode unavailable
+/// }
+/// ...
+/// \endcode
+uint32_t ADS7828::busClock()
 {
-  return read(address_);
+  return clock_;
 }
 
 
-// ___________________________________________ STATIC PRIVATE MEMBER FUNCTIONS
-/// Request and receive data from most-recent A/D conversion from device.
+/// Return quantity of conversions during most-recent acquire().
+/// \optional This function is for testing and troubleshooting.
+/// \return quantity of channels updated (0..32)
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828::acquire();
+/// uint8_t perWake = ADS7828::conversionsPerWake();
+/// ...
+/// \endcode
+uint8_t ADS7828::conversionsPerWake()
+{
+  return wakeConversions_;
+}
+
+
+/// Return pointer to device object.
+/// \param address device address (0..3)
+/// \return pointer to ADS7828 object
+/// \par Usage:
+/// \code
+/// ...
+/// // device 2 pointer
+/// ADS7828* device2 = ADS7828::device(2);
+/// ...
+/// \endcode
+ADS7828* ADS7828::device(uint8_t address)
+{
+  return devices_[address & 0x03];
+}
+
+
+/// Probe device address range, mark registered devices active/inactive.
+/// Each address 0..3 (0x48..0x4B) is probed with a single address-only
+///   transaction, which does not initiate an A/D conversion.
+/// \return bit mask of addresses that acknowledged (0x00..0x0F)
+/// \par Usage:
+/// \code
+/// ...
+/// void setup()
+/// {
+///   ADS7828::begin();
+///   uint8_t present = ADS7828::discover();
+/// }
+/// ...
+/// \endcode
+/// \sa ADS7828::active(), ADS7828::discoveryTime()
+uint8_t ADS7828::discover()
+{
+  return discover(false);
+}
+
+
+/// \overload uint8_t ADS7828::discover(bool autoRegister)
+/// \param autoRegister if true, construct (with default options) and
+///   register a device object for each acknowledging address that has no
+///   registered device
+/// \return bit mask of addresses that acknowledged (0x00..0x0F)
+/// \par Usage:
+/// \code
+/// ...
+/// void setup()
+/// {
+///   ADS7828::begin();
+///   ADS7828::discover(true);
+///   ADS7828* adc = ADS7828::device(0); // 0 if device 0 not present
+/// }
+/// ...
+/// \endcode
+uint8_t ADS7828::discover(bool autoRegister)
+{
+  uint32_t started = micros();
+  uint8_t a, present = 0;
+  for (a = 0; a < 4; a++)
+  {
+    if (0 == probe(0 != devices_[a] ? devices_[a]->bus : &Wire, a))
+    {
+      bitSet(present, a);
+    }
+    if (0 == devices_[a] && autoRegister && bitRead(present, a))
+    {
+      new ADS7828(a);
+    }
+    if (0 != devices_[a]) devices_[a]->active_ = bitRead(present, a);
+  }
+  discoveryTime_ = micros() - started;
+  return present;
+}
+
+
+/// Return duration of most-recent discover().
+/// \optional This function is for testing and troubleshooting.
+/// \return duration (microseconds)
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828::discover();
+/// uint32_t elapsed = ADS7828::discoveryTime();
+/// ...
+/// \endcode
+uint32_t ADS7828::discoveryTime()
+{
+  return discoveryTime_;
+}
+
+
+/// Schedule acquire() sweeps and power devices down between them.
+/// While enabled, the last unmasked channel of each device is converted
+///   with PD1 = PD0 = 0 by acquire(), updateAll(), and update(), so the
+///   device draws only power-down current until the next sweep.
+/// \note The internal reference is also powered down; with
+///   \ref REFERENCE_ON, the first conversion of each sweep starts before
+///   the reference has settled and reads low. Enable the wake-up
+///   conversion (see lowPower(uint32_t, bool)), discard that sample, or use
+///   an external reference.
+/// \param interval interval between sweep starts (milliseconds); 0 disables
+///   low-power mode
+/// \par Usage:
+/// \code
+/// ...
+/// void setup()
+/// {
+///   ADS7828::begin();
+///   // one sweep every 10 seconds
+///   ADS7828::lowPower(10000);
+/// }
+/// ...
+/// \endcode
+/// \sa ADS7828::acquire()
+void ADS7828::lowPower(uint32_t interval)
+{
+  lowPower(interval, false);
+}
+
+
+/// \overload void ADS7828::lowPower(uint32_t interval, bool warmUp)
+/// \param interval interval between sweep starts (milliseconds); 0 disables
+///   low-power mode
+/// \param warmUp if true, acquire() issues one discarded conversion per
+///   device (first unmasked channel) before each sweep, so the reference
+///   and A/D converter are powered up when the sweep starts
+/// \par Usage:
+/// \code
+/// ...
+/// void setup()
+/// {
+///   ADS7828::begin();
+///   // one sweep every 10 seconds, internal reference woken first
+///   ADS7828::lowPower(10000, true);
+/// }
+/// ...
+/// \endcode
+void ADS7828::lowPower(uint32_t interval, bool warmUp)
+{
+  interval_ = interval;
+  scheduled_ = millis();
+  warmUp_ = warmUp;
+}
+
+
+/// Return time awake between wake-ups while waiting for most-recent
+///   acquire() sweep.
+/// Together with wakes(), accounts for the energy spent servicing timer
+///   ticks between sweeps, which awakeTime() excludes.
+/// \optional This function is for testing and troubleshooting.
+/// \return total awake time between wake-ups (microseconds)
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828::acquire();
+/// uint32_t polling = ADS7828::pollTime();
+/// ...
+/// \endcode
+/// \sa ADS7828::wakes()
+uint32_t ADS7828::pollTime()
+{
+  return pollTime_;
+}
+
+
+/// Select order in which updateAll() visits devices/channels.
+/// The order is precomputed into a scan table rather than recomputed on
+///   each pass.
+/// \param order \ref SCAN_DEVICE_MAJOR or \ref SCAN_CHANNEL_MAJOR; other
+///   values are ignored
+/// \par Usage:
+/// \code
+/// ...
+/// void setup()
+/// {
+///   ADS7828::begin();
+///   // sample channel k of every device back-to-back
+///   ADS7828::scanOrder(SCAN_CHANNEL_MAJOR);
+/// }
+/// ...
+/// \endcode
+/// \sa ADS7828::skew()
+void ADS7828::scanOrder(uint8_t order)
+{
+  if (SCAN_DEVICE_MAJOR != order && SCAN_CHANNEL_MAJOR != order) return;
+  scanOrder_ = order;
+  buildScanTable();
+}
+
+
+/// \overload void ADS7828::scanOrder(const uint8_t* table, uint8_t quantity)
+/// \param table (address << 3 | channel) entries in desired order; masked
+///   channels and inactive/unregistered devices are skipped
+/// \param quantity quantity of entries (0..32)
+/// \par Usage:
+/// \code
+/// ...
+/// // voltage (device 0, channel 0) and current (device 1, channel 0)
+/// // back-to-back, followed by slowly-changing temperatures
+/// const uint8_t order[] = { 0 << 3 | 0, 1 << 3 | 0, 0 << 3 | 7, 1 << 3 | 7 };
+/// ADS7828::scanOrder(order, sizeof(order));
+/// ...
+/// \endcode
+void ADS7828::scanOrder(const uint8_t* table, uint8_t quantity)
+{
+  if (quantity > sizeof(scanTable_)) quantity = sizeof(scanTable_);
+  for (uint8_t k = 0; k < quantity; k++) scanTable_[k] = table[k] & 0x1F;
+  scanLength_ = quantity;
+  scanOrder_ = SCAN_CUSTOM_;
+}
+
+
+/// Record every A/D conversion command and result to a compact binary trace.
+/// Each record is:
+/// \arg byte 0: tag; bit 7 set for a result record; bits 6..4 command
+///   or probe status (0..4, see start()); bit 3 set for a probe record;
+///   bits 1..0 device address
+/// \arg bytes 1..2: microseconds since previous record (little-endian,
+///   saturates at 65535)
+/// \arg command record: byte 3 command byte
+/// \arg result record: bytes 3..4 result (big-endian, as on the bus)
+/// \arg probe record (address-only transaction, e.g. discover()): no
+///   further bytes
+///
+/// On Linux, ADS7828Replay feeds such a trace back through update() /
+///   updateAll() for repeatable benchmarks.
+/// \note Records carry no bus identifier. On Linux, recording is
+///   serialized so it is safe while ADS7828Acquisition workers run, but
+///   records from several buses interleave; record and replay one bus at a
+///   time.
+/// \param recorder destination (e.g. \c &Serial, an SD card \c File), or 0
+///   to stop recording
+/// \par Usage:
+/// \code
+/// ...
+/// File trace = SD.open("trace.bin", FILE_WRITE);
+/// ADS7828::record(&trace);
+/// ...
+/// \endcode
+void ADS7828::record(Print* recorder)
+{
+#if !defined(ARDUINO)
+  std::lock_guard<std::mutex> lock(traceMutex);
+#endif
+  traced_ = micros();
+  recorder_ = recorder;
+}
+
+
+/// Return maximum inter-device skew during most-recent updateAll().
+/// Skew is the interval between the first and last sample of the same
+///   channel ID across devices within a single pass; the largest interval
+///   over all channel IDs is reported.
+/// \return skew (microseconds)
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828::updateAll();
+/// uint32_t worst = ADS7828::skew();
+/// ...
+/// \endcode
+uint32_t ADS7828::skew()
+{
+  return skew_;
+}
+
+
+/// Install function that sleeps the MCU between acquire() sweeps.
+/// acquire() calls the function with the time remaining until the next
+///   sweep (milliseconds) in place of sleeping until the next \c millis()
+///   tick, so deeper sleep modes (e.g. watchdog-timed power-down) can
+///   replace roughly 1000 wake-ups per second with a few.
+/// \note The function should return no later than the time it is given
+///   and must keep \c millis() current (e.g. advance it by the time slept
+///   if its timer stops); acquire() calls it again if woken early.
+/// \param hook sleep function; 0 restores the built-in sleep
+/// \par Usage:
+/// \code
+/// ...
+/// void powerDown(uint32_t ms)
+/// {
+///   // e.g. watchdog-timed power-down, millis() compensated
+///   ...
+/// }
+///
+/// void setup()
+/// {
+///   ADS7828::begin();
+///   ADS7828::lowPower(10000);
+///   ADS7828::sleepHook(powerDown);
+/// }
+/// ...
+/// \endcode
+/// \sa ADS7828::acquire(), ADS7828::wakes()
+void ADS7828::sleepHook(void (*hook)(uint32_t))
+{
+  sleepHook_ = hook;
+}
+
+
+/// Update all unmasked channels on all active registered devices.
+/// \required Call this or one of the update() functions
+///   from within \c loop() in order to read data from device(s).
+///   This is the most commonly-used device update function.
+/// \return quantity of channels updated (0..32)
+/// \par Usage:
+/// \code
+/// ...
+/// void loop()
+/// {
+///   ...
+///   // update all registered ADS7828 devices/unmasked channels
+///   uint8_t quantity = ADS7828::updateAll();
+///   ...
+/// }
+/// ...
+/// \endcode
+uint8_t ADS7828::updateAll()
+{
+  uint8_t a, k, count = 0;
+  uint32_t started = micros();
+  beginSweep();
+  if (SCAN_DEVICE_MAJOR == scanOrder_)
+  {
+    for (a = 0; a < 4; a++)
+    {
+      if (0 != devices_[a] && devices_[a]->active_)
+      {
+        count += update(devices_[a]);
+      }
+    }
+  }
+  else
+  {
+    for (k = 0; k < scanLength_; k++)
+    {
+      ADS7828* device = devices_[scanTable_[k] >> 3];
+      uint8_t ch = scanTable_[k] & 0x07;
+      if (0 != device && device->active_ && bitRead(device->channelMask, ch))
+      {
+        if (0 == update(device, ch)) count++;
+      }
+    }
+  }
+  endSweep(count > 0);
+  skew_ = measureSkew(started);
+  return count;
+}
+
+
+/// Return quantity of MCU wake-ups while waiting for most-recent acquire()
+///   sweep.
+/// \optional This function is for testing and troubleshooting.
+/// \return quantity of wake-ups (about 1 per millisecond waited unless a
+///   sleepHook() function sleeps longer)
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828::acquire();
+/// uint32_t wakeUps = ADS7828::wakes();
+/// ...
+/// \endcode
+/// \sa ADS7828::pollTime(), ADS7828::sleepHook()
+uint32_t ADS7828::wakes()
+{
+  return wakes_;
+}
+
+
+// __________________________________________________ PRIVATE MEMBER FUNCTIONS
+/// Common code for constructors.
+/// \param address device address (0..3)
+/// \param options command byte bits SD, PD1, PD0
+/// \param channelMask bit positions containing a 1 represent channels that
+///   are to be read via update() / updateAll()
+/// \param min minimum scaling value applied to value()
+/// \param max maximum scaling value applied to value()
+void ADS7828::init(uint8_t address, uint8_t options,
+  uint8_t channelMask, uint16_t min, uint16_t max)
+{
+  this->active_ = true;
+  this->address_ = address & 0x03;     // A1 A0 bits
+  this->bus = &Wire;
+  this->commandByte_ = options & 0x0C; // PD1 PD0 bits
+  this->channelMask = channelMask;
+  this->hits_ = this->misses_ = 0;
+  for (uint8_t ch = 0; ch < 8; ch++)
+  {
+    channels_[ch] = ADS7828Channel(this, ch, options, min, max);
+  }
+  this->devices_[address_] = this;
+  if (SCAN_CHANNEL_MAJOR == scanOrder_) buildScanTable();
+}
+
+
+/// Request and receive data from most-recent A/D conversion from device.
+/// \return 16-bit zero-padded word (12 data bits D11..D0)
+uint16_t ADS7828::read()
+{
+  return read(bus, address_);
+}
+
+
+// ___________________________________________ STATIC PRIVATE MEMBER FUNCTIONS
+/// Enter high-speed mode if selected via begin().
+/// Master code is sent at fast-mode clock without a STOP condition; all
+///   transactions until endSweep() withhold STOP to keep high-speed mode
+///   latched.
+void ADS7828::beginSweep()
+{
+  if (clock_ <= I2C_FAST_MODE) return;
+  Wire.beginTransmission(HS_MASTER_CODE_ >> 1);
+  Wire.endTransmission(false); // master code is never acknowledged
+  Wire.setClock(clock_);
+  latched_ = &Wire;
+}
+
+
+/// Precompute \ref scanTable_ for \ref SCAN_CHANNEL_MAJOR order.
+/// Every channel of every registered device is included; channel masks and
+///   device activity are checked at scan time so they may change freely.
+void ADS7828::buildScanTable()
+{
+  if (SCAN_CHANNEL_MAJOR != scanOrder_) return;
+  uint8_t a, ch;
+  scanLength_ = 0;
+  for (ch = 0; ch < 8; ch++)
+  {
+    for (a = 0; a < 4; a++)
+    {
+      if (0 != devices_[a]) scanTable_[scanLength_++] = (a << 3) | ch;
+    }
+  }
+}
+
+
+/// Return command byte for conversion of channel during a sweep.
+/// In low-power mode, the device's last unmasked channel selects full
+///   power-down (PD1 = PD0 = 0) following its conversion.
+/// \param device pointer to device object
+/// \param ch channel number (0..7)
+/// \return command byte (0x00..0xFC)
+uint8_t ADS7828::command(ADS7828* device, uint8_t ch)
+{
+  uint8_t result = device->channel(ch)->commandByte();
+  if (0 != interval_ && 0 == (device->channelMask >> ch >> 1))
+  {
+    result &= ~POWER_DOWN_MASK_;
+  }
+  return result;
+}
+
+
+/// Leave high-speed mode if latched by beginSweep().
+/// An address-only transaction issues the closing STOP condition.
+/// \param success false if no transaction in the sweep succeeded; high-speed
+///   mode is then abandoned in favor of fast mode
+void ADS7828::endSweep(bool success)
+{
+  if (0 == latched_) return;
+  latched_ = 0;
+  Wire.beginTransmission(BASE_ADDRESS_);
+  Wire.endTransmission();
+  Wire.setClock(I2C_FAST_MODE);
+  if (!success) clock_ = I2C_FAST_MODE;
+}
+
+
+/// Measure maximum inter-device skew of samples taken since \c started.
+/// \param started micros() at start of pass
+/// \return skew (microseconds)
+uint32_t ADS7828::measureSkew(uint32_t started)
+{
+  uint32_t elapsed = micros() - started, result = 0;
+  uint8_t a, ch;
+  for (ch = 0; ch < 8; ch++)
+  {
+    uint32_t first = elapsed, last = 0;
+    for (a = 0; a < 4; a++)
+    {
+      if (0 == devices_[a] || !bitRead(devices_[a]->channelMask, ch)) continue;
+      uint32_t t = devices_[a]->channels_[ch].timestamp() - started;
+      if (t > elapsed) continue; // not sampled during this pass
+      if (t < first) first = t;
+      if (t > last) last = t;
+    }
+    if (last > first && last - first > result) result = last - first;
+  }
+  return result;
+}
+
+
+/// Address device without sending a command byte.
+/// \param bus I2C bus to which device is connected
+/// \param address device address (0..3)
+/// \retval 0 success
+/// \retval 2 address send, NACK received <b>(device not on bus)</b>
+/// \retval 4 other twi error (lost bus arbitration, bus error, ...)
+uint8_t ADS7828::probe(TwoWire* bus, uint8_t address)
+{
+  bus->beginTransmission(BASE_ADDRESS_ | (address & 0x03));
+  uint8_t status = bus->endTransmission();
+  trace(TRACE_PROBE_ | (status << 4) | (address & 0x03), 0, 0);
+  return status;
+}
+
+
+/// Request and receive data from most-recent A/D conversion from device.
+/// \param bus I2C bus to which device is connected
 /// \param address device address (0..3)
 /// \return 16-bit zero-padded word (12 data bits D11..D0)
-uint16_t ADS7828::read(uint8_t address)
+uint16_t ADS7828::read(TwoWire* bus, uint8_t address)
+{
+  bus->requestFrom((uint8_t) (BASE_ADDRESS_ | (address & 0x03)),
+    (uint8_t) 2, (uint8_t) (bus != latched_));
+  uint8_t high = bus->read();
+  uint16_t result = word(high, bus->read());
+  trace(TRACE_READ_ | (address & 0x03), result, 2);
+  return result;
+}
+
+
+/// Sleep MCU until next timer interrupt (\c millis() tick).
+void ADS7828::sleep()
 {
-  Wire.requestFrom(BASE_ADDRESS_ | (address & 0x03), 2);
-  return word(Wire.read(), Wire.read());
+#if defined(__AVR__)
+  // idle mode keeps timer 0 running; its overflow interrupt wakes the MCU
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  sleep_mode();
+#elif defined(__arm__) && defined(ARDUINO)
+  // SysTick interrupt wakes the core
+  __asm__ volatile ("wfi");
+#else
+  delay(1);
+#endif
 }
 
 
 /// Initiate communication with device.
+/// \param bus I2C bus to which device is connected
 /// \param address device address (0..3)
 /// \param command command byte (0x00..0xFC)
 /// \retval 0 success
@@ -613,11 +1619,37 @@ uint16_t ADS7828::read(uint8_t address)
 /// \retval 2 address send, NACK received <b>(device not on bus)</b>
 /// \retval 3 data send, NACK received
 /// \retval 4 other twi error (lost bus arbitration, bus error, ...)
-uint8_t ADS7828::start(uint8_t address, uint8_t command)
+uint8_t ADS7828::start(TwoWire* bus, uint8_t address, uint8_t command)
+{
+  bus->beginTransmission(BASE_ADDRESS_ | (address & 0x03));
+  bus->write((uint8_t) command);
+  uint8_t status = bus->endTransmission((uint8_t) (bus != latched_));
+  trace((status << 4) | (address & 0x03), command, 1);
+  return status;
+}
+
+
+/// Append record to bus trace if recording.
+/// \param tag record tag (see record())
+/// \param data command byte or conversion result
+/// \param length quantity of data bytes (0..2)
+void ADS7828::trace(uint8_t tag, uint16_t data, uint8_t length)
 {
-  Wire.beginTransmission(BASE_ADDRESS_ | (address & 0x03));
-  Wire.write((uint8_t) command);
-  return Wire.endTransmission();
+  Print* recorder = recorder_;
+  if (0 == recorder) return;
+#if !defined(ARDUINO)
+  // serialize writers; recording may have stopped while waiting
+  std::lock_guard<std::mutex> lock(traceMutex);
+  recorder = recorder_;
+  if (0 == recorder) return;
+#endif
+  uint32_t now = micros(), elapsed = now - traced_;
+  traced_ = now;
+  if (elapsed > 0xFFFF) elapsed = 0xFFFF;
+  uint8_t buffer[5] = { tag, lowByte(elapsed), highByte(elapsed) };
+  if (2 == length) buffer[3] = highByte(data);
+  if (0 != length) buffer[2 + length] = lowByte(data);
+  recorder->write(buffer, 3 + length);
 }
 
 
@@ -628,6 +1660,32 @@ uint8_t ADS7828::update(ADS7828* device)
 {
   if (0 == device) device = devices_[0];
   uint8_t ch, count = 0;
+#if !defined(ARDUINO)
+  // issue all unmasked channels as one I2C_RDWR ioctl; on failure, fall
+  //   through to per-channel transactions to isolate failing channel(s)
+  uint8_t commands[8], ids[8];
+  uint16_t results[8];
+  for (ch = 0; ch < 8; ch++)
+  {
+    if (bitRead(device->channelMask, ch))
+    {
+      ids[count] = ch;
+      commands[count++] = command(device, ch);
+    }
+  }
+  if (0 == device->bus->sweep(BASE_ADDRESS_ | device->address_, commands,
+    count, results))
+  {
+    for (ch = 0; ch < count; ch++)
+    {
+      trace(device->address_, commands[ch], 1);
+      trace(TRACE_READ_ | device->address_, results[ch], 2);
+      device->channel(ids[ch])->newSample(results[ch]);
+    }
+    return count;
+  }
+  count = 0;
+#endif
   for (ch = 0; ch < 8; ch++)
   {
     if (bitRead(device->channelMask, ch))
@@ -650,7 +1708,7 @@ uint8_t ADS7828::update(ADS7828* device)
 uint8_t ADS7828::update(ADS7828* device, uint8_t ch)
 {
   if (0 == device) device = devices_[0];
-  uint8_t status = device->start(ch);
+  uint8_t status = start(device->bus, device->address_, command(device, ch));
   if (0 == status) device->channel(ch)->newSample(device->read());
   return status;
 }
@@ -658,3 +1716,568 @@ uint8_t ADS7828::update(ADS7828* device, uint8_t ch)
 
 // _________________________________________________ STATIC PRIVATE ATTRIBTUES
 ADS7828* ADS7828::devices_[] = {};
+uint32_t ADS7828::awakeTime_ = 0;
+uint32_t ADS7828::clock_ = I2C_STANDARD_MODE;
+uint32_t ADS7828::discoveryTime_ = 0;
+uint32_t ADS7828::interval_ = 0;
+uint32_t ADS7828::pollTime_ = 0;
+uint32_t ADS7828::scheduled_ = 0;
+TwoWire* ADS7828::latched_ = 0;
+uint8_t ADS7828::scanOrder_ = SCAN_DEVICE_MAJOR;
+uint8_t ADS7828::scanLength_ = 0;
+uint8_t ADS7828::scanTable_[] = {};
+uint32_t ADS7828::skew_ = 0;
+#if defined(ARDUINO)
+Print* ADS7828::recorder_ = 0;
+#else
+std::atomic<Print*> ADS7828::recorder_(0);
+#endif
+uint32_t ADS7828::traced_ = 0;
+void (*ADS7828::sleepHook_)(uint32_t) = 0;
+bool ADS7828::warmUp_ = false;
+uint8_t ADS7828::wakeConversions_ = 0;
+uint32_t ADS7828::wakes_ = 0;
+
+
+// ___________________________________________________ PUBLIC MEMBER FUNCTIONS
+/// Constructor.
+/// \param window quantity of samples per window (1..65535)
+/// \par Usage:
+/// \code
+/// ...
+/// // 60 Hz mains scanned at 1200 samples/s: 10 cycles per window
+/// ADS7828Rms mains(200);
+/// ...
+/// \endcode
+ADS7828Rms::ADS7828Rms(uint16_t window)
+{
+  this->window_ = (0 == window) ? 1 : window;
+  reset();
+}
+
+
+/// Return mean (DC component) of most-recent complete window.
+/// \return (unscaled) mean (0x0000..0x0FFF)
+uint16_t ADS7828Rms::mean()
+{
+  return mean_;
+}
+
+
+/// Accumulate sample; compute results at end of window.
+/// \param sample sample value (0x0000..0x0FFF)
+/// \remark Invoked by ADS7828Channel::newSample();
+///   this function will not normally be called by end user.
+void ADS7828Rms::newSample(uint16_t sample)
+{
+  this->sum_ += sample;
+  this->sumSquares_ += (uint32_t) sample * sample;
+  if (++count_ < window_) return;
+
+  // N^2 x variance = N x sum(x^2) - sum(x)^2
+  uint64_t n = count_;
+  this->mean_ = sum_ / count_;
+  this->rms_ = squareRoot(n * sumSquares_ - (uint64_t) sum_ * sum_) / count_;
+  this->count_ = this->sum_ = 0;
+  this->sumSquares_ = 0;
+}
+
+
+/// Discard current window and results.
+void ADS7828Rms::reset()
+{
+  this->count_ = this->mean_ = this->rms_ = 0;
+  this->sum_ = 0;
+  this->sumSquares_ = 0;
+}
+
+
+/// Return AC RMS (DC component removed) of most-recent complete window.
+/// \return (unscaled) RMS (0x0000..0x07FF)
+uint16_t ADS7828Rms::rms()
+{
+  return rms_;
+}
+
+
+// ___________________________________________________ PUBLIC MEMBER FUNCTIONS
+/// Constructor.
+/// \param voltage voltage channel, paired with the channel to which the
+///   object is attached (current)
+/// \param window quantity of sample pairs per window (1..65535)
+ADS7828Power::ADS7828Power(ADS7828Channel* voltage, uint16_t window)
+{
+  this->voltage_ = voltage;
+  this->window_ = (0 == window) ? 1 : window;
+  reset();
+}
+
+
+/// Return current AC RMS of most-recent complete window.
+/// \return (unscaled) RMS (0x0000..0x07FF)
+uint16_t ADS7828Power::currentRms()
+{
+  return currentRms_;
+}
+
+
+/// Accumulate current sample paired with most-recent voltage sample;
+///   compute results at end of window.
+/// \param current current sample value (0x0000..0x0FFF)
+/// \remark Invoked by ADS7828Channel::newSample();
+///   this function will not normally be called by end user.
+void ADS7828Power::newSample(uint16_t current)
+{
+  uint16_t voltage = voltage_->sample();
+  this->sumVoltage_ += voltage;
+  this->sumCurrent_ += current;
+  this->sumVoltageSquares_ += (uint32_t) voltage * voltage;
+  this->sumCurrentSquares_ += (uint32_t) current * current;
+  this->sumProducts_ += (uint32_t) voltage * current;
+  if (++count_ < window_) return;
+
+  // N^2 x covariance = N x sum(xy) - sum(x) x sum(y)
+  uint64_t n = count_;
+  this->voltageRms_ = squareRoot(n * sumVoltageSquares_ -
+    (uint64_t) sumVoltage_ * sumVoltage_) / count_;
+  this->currentRms_ = squareRoot(n * sumCurrentSquares_ -
+    (uint64_t) sumCurrent_ * sumCurrent_) / count_;
+  this->realPower_ = ((int64_t) (n * sumProducts_) -
+    (int64_t) ((uint64_t) sumVoltage_ * sumCurrent_)) / (int64_t) (n * n);
+  this->count_ = 0;
+  this->sumVoltage_ = this->sumCurrent_ = 0;
+  this->sumVoltageSquares_ = this->sumCurrentSquares_ = 0;
+  this->sumProducts_ = 0;
+}
+
+
+/// Return power factor (real power / apparent power) of most-recent
+///   complete window.
+/// \return power factor (per mille, -1000..1000)
+int16_t ADS7828Power::powerFactor()
+{
+  int32_t apparent = (int32_t) voltageRms_ * currentRms_;
+  if (0 == apparent) return 0;
+  return (int64_t) realPower_ * 1000 / apparent;
+}
+
+
+/// Return real (mean instantaneous AC) power of most-recent complete window.
+/// \return (unscaled) power (counts x counts)
+int32_t ADS7828Power::realPower()
+{
+  return realPower_;
+}
+
+
+/// Discard current window and results.
+void ADS7828Power::reset()
+{
+  this->count_ = this->currentRms_ = this->voltageRms_ = 0;
+  this->realPower_ = 0;
+  this->sumVoltage_ = this->sumCurrent_ = 0;
+  this->sumVoltageSquares_ = this->sumCurrentSquares_ = 0;
+  this->sumProducts_ = 0;
+}
+
+
+/// Return voltage AC RMS of most-recent complete window.
+/// \return (unscaled) RMS (0x0000..0x07FF)
+uint16_t ADS7828Power::voltageRms()
+{
+  return voltageRms_;
+}
+
+
+// ___________________________________________________ PUBLIC MEMBER FUNCTIONS
+/// Constructor.
+/// \param frequency target frequency (Hz); rounded to nearest bin, limited
+///   to bins 1..blockSize / 2 (DC is not a valid target)
+/// \param sampleRate rate at which attached channel is sampled (samples/s)
+/// \param blockSize quantity of samples per block (2..1000, clamped); larger
+///   blocks narrow the bin but update magnitude() less often
+ADS7828Goertzel::ADS7828Goertzel(uint16_t frequency, uint16_t sampleRate,
+  uint16_t blockSize)
+{
+  // blocks over 1000 samples could overflow resonator state
+  if (blockSize < 2) blockSize = 2;
+  if (blockSize > 1000) blockSize = 1000;
+  this->blockSize_ = blockSize;
+  if (0 == sampleRate) sampleRate = 1;
+  uint32_t bin = ((uint32_t) blockSize_ * frequency + sampleRate / 2) /
+    sampleRate;
+  // bin 0 (coefficient 2.0) grows without bound on any DC offset
+  if (bin < 1) bin = 1;
+  if (bin > blockSize_ / 2U) bin = blockSize_ / 2U;
+  this->coefficient_ = lround(2.0 * cos(TWO_PI * bin / blockSize_) *
+    (1L << COEFFICIENT_BITS_));
+  this->blocks_ = 0;
+  reset();
+}
+
+
+/// Return quantity of completed blocks.
+/// \optional Compare with a previous value to detect a new magnitude().
+/// \return block count (wraps at 65535)
+uint16_t ADS7828Goertzel::blocks()
+{
+  return blocks_;
+}
+
+
+/// Return amplitude of target tone over most-recent complete block.
+/// \return (unscaled) peak amplitude (0x0000..0x07FF)
+uint16_t ADS7828Goertzel::magnitude()
+{
+  return magnitude_;
+}
+
+
+/// Run resonator on sample; compute magnitude at end of block.
+/// \param sample sample value (0x0000..0x0FFF)
+/// \remark Invoked by ADS7828Channel::newSample();
+///   this function will not normally be called by end user.
+void ADS7828Goertzel::newSample(uint16_t sample)
+{
+  // center on mid-scale to bound resonator state; DC does not leak into
+  //   an integer bin over a whole block
+  int32_t s = (int32_t) sample - 2048 +
+    (int32_t) (((int64_t) coefficient_ * s1_) >> COEFFICIENT_BITS_) - s2_;
+  this->s2_ = s1_;
+  this->s1_ = s;
+  if (++count_ < blockSize_) return;
+
+  // |X(k)|^2 = s1^2 + s2^2 - coefficient x s1 x s2; amplitude = 2|X(k)| / N
+  int64_t power = (int64_t) s1_ * s1_ + (int64_t) s2_ * s2_ -
+    (((int64_t) coefficient_ * s1_) >> COEFFICIENT_BITS_) * s2_;
+  this->magnitude_ = 2 * squareRoot(power > 0 ? power : 0) / blockSize_;
+  this->blocks_++;
+  this->count_ = 0;
+  this->s1_ = this->s2_ = 0;
+}
+
+
+/// Discard current block and result.
+void ADS7828Goertzel::reset()
+{
+  this->count_ = this->magnitude_ = 0;
+  this->s1_ = this->s2_ = 0;
+}
+
+
+// ___________________________________________________ PUBLIC MEMBER FUNCTIONS
+/// Constructor.
+/// \param window quantity of samples per window (0 = unbounded; statistics
+///   then accumulate until reset(), up to 65535 samples)
+ADS7828Statistics::ADS7828Statistics(uint16_t window)
+{
+  this->window_ = window;
+  reset();
+}
+
+
+/// Return quantity of samples accumulated.
+/// \return sample count (0..65535)
+uint16_t ADS7828Statistics::count()
+{
+  return count_;
+}
+
+
+/// Return largest sample accumulated.
+/// \return (unscaled) sample value (0x0000..0x0FFF; 0 if none)
+uint16_t ADS7828Statistics::maximum()
+{
+  return maximum_;
+}
+
+
+/// Return mean of samples accumulated.
+/// \return (unscaled) mean
+float ADS7828Statistics::mean()
+{
+  return (float) mean_ / (1L << FRACTION_BITS_);
+}
+
+
+/// Return smallest sample accumulated.
+/// \return (unscaled) sample value (0x0000..0x0FFF; 0 if none)
+uint16_t ADS7828Statistics::minimum()
+{
+  return (0 == count_) ? 0 : minimum_;
+}
+
+
+/// Update minimum, maximum, and Welford mean/squared-deviation accumulators.
+/// \param sample sample value (0x0000..0x0FFF)
+/// \remark Invoked by ADS7828Channel::newSample();
+///   this function will not normally be called by end user.
+void ADS7828Statistics::newSample(uint16_t sample)
+{
+  if ((0 != window_ && count_ >= window_) || 0xFFFF == count_) reset();
+  this->count_++;
+  if (sample < minimum_) this->minimum_ = sample;
+  if (sample > maximum_) this->maximum_ = sample;
+
+  int32_t x = (int32_t) sample << FRACTION_BITS_;
+  int32_t delta = x - mean_;
+  this->mean_ += delta / count_;
+  this->squares_ += ((int64_t) delta * (x - mean_)) >> FRACTION_BITS_;
+}
+
+
+/// Discard accumulated samples and restart statistics.
+void ADS7828Statistics::reset()
+{
+  this->count_ = this->maximum_ = 0;
+  this->minimum_ = 0xFFFF;
+  this->mean_ = 0;
+  this->squares_ = 0;
+}
+
+
+/// Return sample standard deviation of samples accumulated.
+/// \return (unscaled) standard deviation
+float ADS7828Statistics::standardDeviation()
+{
+  return sqrt(variance());
+}
+
+
+/// Return sample variance of samples accumulated.
+/// \return (unscaled) variance (0 if fewer than 2 samples)
+float ADS7828Statistics::variance()
+{
+  if (count_ < 2) return 0;
+  return (float) squares_ / (1L << FRACTION_BITS_) / (count_ - 1);
+}
+
+
+// ___________________________________________________ PUBLIC MEMBER FUNCTIONS
+/// Constructor.
+/// \param keyInterval quantity of frames between key frames (1..255);
+///   1 sends every frame as a key frame
+ADS7828Encoder::ADS7828Encoder(uint8_t keyInterval)
+{
+  this->keyInterval_ = (0 == keyInterval) ? 1 : keyInterval;
+  this->sequence_ = 0;
+  reset();
+}
+
+
+/// Encode most-recent samples of unmasked channels of one device.
+/// \param device device object
+/// \param buffer destination of at least \ref MAX_FRAME_SIZE bytes
+/// \return frame length (bytes)
+uint8_t ADS7828Encoder::encode(ADS7828* device, uint8_t* buffer)
+{
+  ADS7828* devices[4] = {};
+  devices[device->address()] = device;
+  return encode(devices, 1 << device->address(), buffer);
+}
+
+
+/// Encode most-recent samples of unmasked channels of all active registered
+///   devices (e.g. following ADS7828::updateAll()).
+/// \param buffer destination of at least \ref MAX_FRAME_SIZE bytes
+/// \return frame length (bytes)
+uint8_t ADS7828Encoder::encodeAll(uint8_t* buffer)
+{
+  ADS7828* devices[4];
+  uint8_t a, present = 0;
+  for (a = 0; a < 4; a++)
+  {
+    devices[a] = ADS7828::device(a);
+    if (0 != devices[a] && devices[a]->active()) bitSet(present, a);
+  }
+  return encode(devices, present, buffer);
+}
+
+
+/// Force next frame to be a key frame.
+void ADS7828Encoder::reset()
+{
+  this->devices_ = 0;
+  this->sinceKey_ = 0;
+}
+
+
+// __________________________________________________ PRIVATE MEMBER FUNCTIONS
+/// Encode frame.
+/// \param devices device objects indexed by address
+/// \param present bitmap of addresses to encode
+/// \param buffer destination of at least \ref MAX_FRAME_SIZE bytes
+/// \return frame length (bytes)
+uint8_t ADS7828Encoder::encode(ADS7828** devices, uint8_t present,
+  uint8_t* buffer)
+{
+  uint8_t a, ch, length;
+  bool key = (0 == sinceKey_ || present != devices_);
+  for (a = 0; a < 4; a++)
+  {
+    if (bitRead(present, a) && devices[a]->channelMask != masks_[a]) key = true;
+  }
+  this->sinceKey_ = (key ? 0 : sinceKey_) + 1;
+  if (sinceKey_ >= keyInterval_) this->sinceKey_ = 0;
+  this->devices_ = present;
+
+  buffer[0] = SYNC;
+  buffer[1] = (key << 7) | present;
+  buffer[2] = sequence_++;
+  length = 3;
+  for (a = 0; a < 4; a++)
+  {
+    if (!bitRead(present, a)) continue;
+    uint8_t mask = devices[a]->channelMask;
+    uint16_t fields[8];
+    uint8_t width = 12;
+    if (!key)
+    {
+      uint16_t largest = 0;
+      for (ch = 0; ch < 8; ch++)
+      {
+        if (!bitRead(mask, ch)) continue;
+        int16_t delta = devices[a]->channel(ch)->sample() - previous_[a][ch];
+        fields[ch] = (delta << 1) ^ (delta >> 15); // zigzag
+        if (fields[ch] > largest) largest = fields[ch];
+      }
+      for (width = 0; largest > 0; largest >>= 1) width++;
+    }
+
+    uint16_t position = 0;
+    uint8_t* data = &buffer[length + 2];
+    for (ch = 0; ch < 13; ch++) data[ch] = 0; // 8 x 13 bits, worst case
+    for (ch = 0; ch < 8; ch++)
+    {
+      if (!bitRead(mask, ch)) continue;
+      uint16_t sample = devices[a]->channel(ch)->sample();
+      putBits(data, position, key ? sample : fields[ch], width);
+      this->previous_[a][ch] = sample;
+    }
+    buffer[length] = mask;
+    buffer[length + 1] = width;
+    length += 2 + (position + 7) / 8;
+    this->masks_[a] = mask;
+  }
+
+  uint16_t crc = crc16(&buffer[1], length - 1);
+  buffer[length++] = highByte(crc);
+  buffer[length++] = lowByte(crc);
+  return length;
+}
+
+
+// ___________________________________________________ PUBLIC MEMBER FUNCTIONS
+/// Constructor.
+ADS7828Decoder::ADS7828Decoder()
+{
+  reset();
+}
+
+
+/// Return channel mask of device in most-recent frame.
+/// \param address device address (0..3)
+uint8_t ADS7828Decoder::channelMask(uint8_t address)
+{
+  return masks_[address & 0x03];
+}
+
+
+/// Decode frame, updating values().
+/// \param buffer frame
+/// \param length frame length (bytes)
+/// \retval 0 success
+/// \retval 1 malformed frame (sync, length)
+/// \retval 2 CRC mismatch
+/// \retval 3 delta frame without a preceding key frame (start-up or lost
+///   frame); values unchanged until next key frame
+uint8_t ADS7828Decoder::decode(const uint8_t* buffer, uint8_t length)
+{
+  uint8_t a, ch, offset = 3;
+  if (length < 5 || ADS7828Encoder::SYNC != buffer[0]) return 1;
+  if (crc16(&buffer[1], length - 3) !=
+    word(buffer[length - 2], buffer[length - 1])) return 2;
+
+  bool key = bitRead(buffer[1], 7);
+  if (!key && (!synced_ || (uint8_t) (sequence_ + 1) != buffer[2]))
+  {
+    this->synced_ = false;
+    return 3;
+  }
+
+  uint8_t present = buffer[1] & 0x0F;
+  uint16_t decoded[4][8];
+  uint8_t masks[4] = {};
+  for (a = 0; a < 4; a++)
+  {
+    if (!bitRead(present, a)) continue;
+    if (offset + 2 > length - 2) return 1;
+    uint8_t mask = buffer[offset];
+    uint8_t width = buffer[offset + 1];
+    uint16_t position = 0;
+    uint8_t quantity = 0;
+    for (ch = 0; ch < 8; ch++) quantity += bitRead(mask, ch);
+    if (width > 13 || offset + 2 + (quantity * width + 7) / 8 > length - 2)
+    {
+      return 1;
+    }
+    for (ch = 0; ch < 8; ch++)
+    {
+      if (!bitRead(mask, ch)) continue;
+      uint16_t field = getBits(&buffer[offset + 2], position, width);
+      decoded[a][ch] = key ? field :
+        values_[a][ch] + (int16_t) ((field >> 1) ^ -(field & 1)); // zigzag
+    }
+    masks[a] = mask;
+    offset += 2 + (position + 7) / 8;
+  }
+
+  for (a = 0; a < 4; a++)
+  {
+    this->masks_[a] = masks[a];
+    for (ch = 0; ch < 8; ch++)
+    {
+      if (bitRead(masks[a], ch)) this->values_[a][ch] = decoded[a][ch];
+    }
+  }
+  this->devices_ = present;
+  this->sequence_ = buffer[2];
+  this->synced_ = true;
+  return 0;
+}
+
+
+/// Return bitmap of device addresses in most-recent frame.
+uint8_t ADS7828Decoder::devices()
+{
+  return devices_;
+}
+
+
+/// Discard state; next frame must be a key frame.
+void ADS7828Decoder::reset()
+{
+  this->devices_ = this->sequence_ = 0;
+  this->synced_ = false;
+  for (uint8_t a = 0; a < 4; a++)
+  {
+    this->masks_[a] = 0;
+    for (uint8_t ch = 0; ch < 8; ch++) this->values_[a][ch] = 0;
+  }
+}
+
+
+/// Return sequence number of most-recent frame.
+uint8_t ADS7828Decoder::sequence()
+{
+  return sequence_;
+}
+
+
+/// Return (unscaled) sample of device/channel in most-recent frame.
+/// \param address device address (0..3)
+/// \param ch channel number (0..7)
+uint16_t ADS7828Decoder::value(uint8_t address, uint8_t ch)
+{
+  return values_[address & 0x03][ch & 0x07];
+}
@@ -47,6 +47,11 @@
 /// \par Caveats
 ///   Conforms to Arduino IDE 1.5 Library Specification v2.1 which requires
 ///   Arduino IDE >= 1.5.
+/// \par Linux
+///   When compiled without \c ARDUINO defined on a Linux host, the library
+///   uses a Wire-compatible /dev/i2c-N backend (see TwoWire in
+///   i2c_adc_ads7828_linux.h); each device sweep is issued as a single
+///   \c I2C_RDWR ioctl.
 /// \par Support
 /// Please [submit an issue](https://github.com/4-20ma/i2c_adc_ads7828/
 /// issues) for all questions, bug reports, and feature requests. Email
@@ -74,13 +79,23 @@
 #define i2c_adc_ads7828_h
 
 // _________________________________________________________ STANDARD INCLUDES
+#if defined(ARDUINO)
 // include types & constants of Wiring core API
 #include "Arduino.h"
+#endif
 
 
 // __________________________________________________________ PROJECT INCLUDES
+#if defined(ARDUINO)
 // include twi/i2c library
 #include <Wire.h>
+#elif defined(__linux__)
+// include /dev/i2c-N twi/i2c library
+#include <atomic>
+#include "i2c_adc_ads7828_linux.h"
+#else
+#error "i2c_adc_ads7828 requires Arduino or Linux"
+#endif
 
 
 // ____________________________________________________________ UTILITY MACROS
@@ -186,22 +201,79 @@ static const uint16_t DEFAULT_MIN_SCALE    = 0;
 static const uint16_t DEFAULT_MAX_SCALE    = 0xFFF;
 
 
+/// I2C standard-mode bus clock (100 kHz); Wire library default.
+/// \relates ADS7828
+static const uint32_t I2C_STANDARD_MODE    = 100000;
+
+
+/// I2C fast-mode bus clock (400 kHz).
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828::begin(I2C_FAST_MODE);
+/// ...
+/// \endcode
+/// \relates ADS7828
+static const uint32_t I2C_FAST_MODE        = 400000;
+
+
+/// I2C high-speed-mode bus clock (3.4 MHz).
+/// High-speed mode is not achievable through the generic Wire API; it is
+///   used only on cores whose Wire library holds the bus across the master
+///   code and a clock change, and only if verified by begin(). All other
+///   platforms fall back to \ref I2C_FAST_MODE.
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828::begin(I2C_HIGH_SPEED_MODE);
+/// ...
+/// \endcode
+/// \relates ADS7828
+static const uint32_t I2C_HIGH_SPEED_MODE  = 3400000;
+
+
+/// Scan order for updateAll(): all channels of device 0, then device 1...
+///   (default).
+/// \relates ADS7828
+static const uint8_t SCAN_DEVICE_MAJOR     = 0;
+
+
+/// Scan order for updateAll(): channel k of every device back-to-back,
+///   then channel k+1, minimizing inter-device skew for each channel.
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828::scanOrder(SCAN_CHANNEL_MAJOR);
+/// ...
+/// \endcode
+/// \relates ADS7828
+static const uint8_t SCAN_CHANNEL_MAJOR    = 1;
+
+
 // _________________________________________________________ CLASS DEFINITIONS
 class ADS7828;
+class ADS7828Accumulator;
 class ADS7828Channel
 {
   public:
     // ............................................... public member functions
     ADS7828Channel() {};
     ADS7828Channel(ADS7828* const, uint8_t, uint8_t, uint16_t, uint16_t);
+    void attach(ADS7828Accumulator*);
     uint8_t commandByte();
+    void detach(ADS7828Accumulator*);
     ADS7828* device();
+    bool fresh();
     uint8_t id();
     uint8_t index();
     void newSample(uint16_t);
+    void prime(uint16_t);
     void reset();
+    uint8_t restore(const uint8_t*);
     uint16_t sample();
+    uint8_t snapshot(uint8_t*);
     uint8_t start();
+    uint32_t timestamp();
     uint16_t total();
     uint8_t update();
     uint16_t value();
@@ -209,6 +281,20 @@ class ADS7828Channel
     // ........................................ static public member functions
 
     // ..................................................... public attributes
+    /// Freshness window (microseconds); update() requests arriving within
+    ///   this interval of the most-recent sample are served from it without
+    ///   a bus transaction (defaults to 0, disabled).
+    /// \par Usage:
+    /// \code
+    /// ...
+    /// ADS7828 device(0);
+    /// ADS7828Channel* temperature = device.channel(0);
+    /// temperature->maxAge = 500; // reuse conversions up to 500 us old
+    /// ...
+    /// \endcode
+    /// \sa ADS7828::hits(), ADS7828::misses()
+    uint32_t maxAge;
+
     /// Maximum value of moving average (defaults to 0x0FFF).
     /// \par Usage:
     /// \code
@@ -234,6 +320,10 @@ class ADS7828Channel
     uint16_t minScale;
 
     // .............................................. static public attributes
+    /// Quantity of bytes written by snapshot() / read by restore()
+    ///   (index byte + little-endian sample array).
+    /// \note Bit shift must match \ref MOVING_AVERAGE_BITS_.
+    static const uint8_t SNAPSHOT_SIZE = 1 + sizeof(uint16_t) * (1 << 4);
 
   private:
     // .............................................. private member functions
@@ -241,6 +331,9 @@ class ADS7828Channel
     // ....................................... static private member functions
 
     // .................................................... private attributes
+    /// First of chain of accumulators fed by newSample() (0 if none).
+    ADS7828Accumulator* accumulators_;
+
     /// Command byte for channel object (SD C2 C1 C0 bits only).
     uint8_t commandByte_;
 
@@ -250,10 +343,17 @@ class ADS7828Channel
     /// Index position within moving average array. 
     uint8_t index_;
 
+    /// True once moving average array has been filled with a real sample;
+    ///   cleared by reset() so the next sample primes the entire array.
+    bool primed_;
+
     /// Array of (unscaled) sample values.
     /// \note Bit shift must match \ref MOVING_AVERAGE_BITS_.
     uint16_t samples_[1 << 4];
 
+    /// Time of most-recent sample (microseconds).
+    uint32_t timestamp_;
+
     /// (Unscaled) running total of moving average array elements.
     uint16_t total_;
 
@@ -273,20 +373,54 @@ class ADS7828
     ADS7828(uint8_t, uint8_t);
     ADS7828(uint8_t, uint8_t, uint8_t);
     ADS7828(uint8_t, uint8_t, uint8_t, uint16_t, uint16_t);
+    bool active();
     uint8_t address();
     ADS7828Channel* channel(uint8_t);
     uint8_t commandByte();
+    uint32_t hits();
+    uint32_t misses();
     uint8_t start();
     uint8_t start(uint8_t);
     uint8_t update(); // single device, all unmasked channel
     uint8_t update(uint8_t); // single device, single channel
 
     // ........................................ static public member functions
+    static uint8_t acquire(); // sleep until scheduled, then updateAll()
+    static uint32_t awakeTime();
     static void begin();
+    static void begin(uint32_t);
+    static uint32_t busClock();
+    static uint8_t conversionsPerWake();
     static ADS7828* device(uint8_t);
+    static uint8_t discover();
+    static uint8_t discover(bool);
+    static uint32_t discoveryTime();
+    static void lowPower(uint32_t);
+    static void lowPower(uint32_t, bool);
+    static uint32_t pollTime();
+    static void scanOrder(uint8_t);
+    static void scanOrder(const uint8_t*, uint8_t);
+    static void record(Print*);
+    static uint32_t skew();
+    static void sleepHook(void (*)(uint32_t));
     static uint8_t updateAll(); // all devices, all unmasked channels
+    static uint32_t wakes();
 
     // ..................................................... public attributes
+    /// I2C bus to which device is connected (defaults to \c &Wire).
+    /// \note The device registry (device(), discover(), updateAll()) holds
+    ///   one device per address; devices sharing an address on other buses
+    ///   should be updated via update() or ADS7828Acquisition.
+    /// \par Usage:
+    /// \code
+    /// ...
+    /// ADS7828 adc(0);
+    /// ...
+    /// adc.bus = &Wire1;
+    /// ...
+    /// \endcode
+    TwoWire* bus;
+
     /// Each bit position containing a 1 represents a channel that is to be
     /// read via update() / updateAll().
     uint8_t channelMask;                    // mask of active channels
@@ -299,12 +433,24 @@ class ADS7828
     uint16_t read();
 
     // ....................................... static private member functions
-    static uint16_t read(uint8_t);
-    static uint8_t start(uint8_t, uint8_t);
+    static void beginSweep();
+    static void buildScanTable();
+    static uint8_t command(ADS7828*, uint8_t);
+    static void endSweep(bool);
+    static uint32_t measureSkew(uint32_t);
+    static uint8_t probe(TwoWire*, uint8_t);
+    static uint16_t read(TwoWire*, uint8_t);
+    static uint8_t start(TwoWire*, uint8_t, uint8_t);
+    static void sleep();
+    static void trace(uint8_t, uint16_t, uint8_t);
     static uint8_t update(ADS7828*); // single device, all unmasked channels
     static uint8_t update(ADS7828*, uint8_t); // single device, single channel
 
     // .................................................... private attributes
+    /// False if device did not acknowledge during discover();
+    ///   inactive devices are skipped by updateAll().
+    bool active_;
+
     /// Device address as defined by pins A1, A0
     uint8_t address_;
 
@@ -314,12 +460,635 @@ class ADS7828
     /// Command byte for device object (PD1 PD0 bits only).
     uint8_t commandByte_;
 
+    /// Quantity of update(uint8_t) requests served from a fresh sample.
+    uint32_t hits_;
+
+    /// Quantity of update(uint8_t) requests that required a conversion.
+    uint32_t misses_;
+
     // ............................................. static private attributes
+    /// Awake time per conversion during most-recent acquire()
+    ///   (microseconds).
+    static uint32_t awakeTime_;
+
+    /// Bus clock requested via begin() (Hz); values above
+    ///   \ref I2C_FAST_MODE select high-speed mode.
+    static uint32_t clock_;
+
     /// Array of pointers to registered device objects.
     static ADS7828* devices_[4];
 
+    /// Duration of most-recent discover() (microseconds).
+    static uint32_t discoveryTime_;
+
+    /// Interval between acquire() sweeps (milliseconds); 0 if low-power
+    ///   mode is disabled.
+    static uint32_t interval_;
+
+    /// Time awake between wake-ups while waiting for most-recent acquire()
+    ///   sweep (microseconds).
+    static uint32_t pollTime_;
+
+    /// millis() at which next acquire() sweep is scheduled.
+    static uint32_t scheduled_;
+
+    /// Scan order (\ref SCAN_DEVICE_MAJOR, \ref SCAN_CHANNEL_MAJOR, or
+    ///   \ref SCAN_CUSTOM_).
+    static uint8_t scanOrder_;
+
+    /// Quantity of entries in \ref scanTable_.
+    static uint8_t scanLength_;
+
+    /// (address << 3 | channel) entries visited in order by updateAll();
+    ///   rebuilt when a device is registered.
+    static uint8_t scanTable_[32];
+
+    /// Maximum inter-device skew for any channel during most-recent
+    ///   updateAll() (microseconds).
+    static uint32_t skew_;
+
+    /// User function that sleeps the MCU for up to the given time
+    ///   (milliseconds) between acquire() sweeps; 0 to sleep until the next
+    ///   \c millis() tick.
+    static void (*sleepHook_)(uint32_t);
+
+    /// Issue a discarded wake-up conversion per device before each
+    ///   acquire() sweep.
+    static bool warmUp_;
+
+    /// Quantity of conversions during most-recent acquire().
+    static uint8_t wakeConversions_;
+
+    /// Quantity of MCU wake-ups while waiting for most-recent acquire()
+    ///   sweep.
+    static uint32_t wakes_;
+
+    /// Destination of bus trace records (0 if not recording); atomic on
+    ///   Linux so trace() can skip the lock when not recording.
+#if defined(ARDUINO)
+    static Print* recorder_;
+#else
+    static std::atomic<Print*> recorder_;
+#endif
+
+    /// micros() at most-recent trace record.
+    static uint32_t traced_;
+
+    /// Bus on which high-speed mode is latched (STOP conditions withheld);
+    ///   0 if not latched.
+    static TwoWire* latched_;
+
     /// Factory pre-set slave address.
     static const uint8_t BASE_ADDRESS_ = 0x48;
+
+    /// High-speed mode master code (0000 1XXX, sent as 7-bit address).
+    static const uint8_t HS_MASTER_CODE_ = 0x08;
+
+    /// Command byte power-down selection bits (PD1, PD0).
+    static const uint8_t POWER_DOWN_MASK_ = REFERENCE_ON | ADC_ON;
+
+    /// Scan order set via scanOrder(const uint8_t*, uint8_t).
+    static const uint8_t SCAN_CUSTOM_ = 2;
+
+    /// Trace record tag bit marking a probe() (address-only) record.
+    static const uint8_t TRACE_PROBE_ = 0x08;
+
+    /// Trace record tag bit marking a read() record.
+    static const uint8_t TRACE_READ_ = 0x80;
+};
+
+
+/// Base class of streaming computations fed from ADS7828Channel::newSample().
+/// Derived classes process each (unscaled) sample in constant time and
+///   memory; attach an instance to a channel with ADS7828Channel::attach().
+/// \note An accumulator may be attached to only one channel at a time;
+///   further attach() calls are ignored until it is detached.
+class ADS7828Accumulator
+{
+  public:
+    // ............................................... public member functions
+    ADS7828Accumulator() : channel_(0), next_(0) {};
+
+    /// Process (unscaled) sample value.
+    /// \param sample sample value (0x0000..0x0FFF)
+    /// \remark Invoked by ADS7828Channel::newSample();
+    ///   this function will not normally be called by end user.
+    virtual void newSample(uint16_t sample) = 0;
+
+  private:
+    // .................................................... private attributes
+    friend class ADS7828Channel;
+
+    /// Channel to which accumulator is attached (0 if none).
+    ADS7828Channel* channel_;
+
+    /// Next accumulator attached to the same channel (0 if last).
+    ADS7828Accumulator* next_;
+};
+
+
+/// Windowed mean and AC RMS of one channel, computed from running sum and
+///   sum of squares in integer math without storing samples.
+/// Results are updated at the end of each window.
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0, SINGLE_ENDED | REFERENCE_ON | ADC_ON);
+/// ADS7828Rms mains(200); // 200-sample window
+/// ...
+/// void setup()
+/// {
+///   adc.channel(0)->attach(&mains);
+/// }
+/// ...
+/// uint16_t vrms = mains.rms();
+/// ...
+/// \endcode
+class ADS7828Rms : public ADS7828Accumulator
+{
+  public:
+    // ............................................... public member functions
+    ADS7828Rms(uint16_t);
+    uint16_t mean();
+    void newSample(uint16_t);
+    void reset();
+    uint16_t rms();
+
+  private:
+    // .................................................... private attributes
+    /// Quantity of samples accumulated in current window.
+    uint16_t count_;
+
+    /// Mean of most-recent complete window.
+    uint16_t mean_;
+
+    /// AC RMS of most-recent complete window.
+    uint16_t rms_;
+
+    /// Sum of samples in current window.
+    uint32_t sum_;
+
+    /// Sum of squared samples in current window.
+    uint64_t sumSquares_;
+
+    /// Quantity of samples per window.
+    uint16_t window_;
+};
+
+
+/// Windowed voltage/current RMS, real power, and power factor of a pair of
+///   channels, computed from running sums and cross products in integer
+///   math without storing samples.
+/// Attach to the current channel; each current sample is paired with the
+///   most-recent voltage sample, so the voltage channel should be scanned
+///   immediately before the current channel.
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0, SINGLE_ENDED | REFERENCE_ON | ADC_ON);
+/// ADS7828Power load(adc.channel(0), 200); // voltage on channel 0
+/// ...
+/// void setup()
+/// {
+///   adc.channel(1)->attach(&load);        // current on channel 1
+/// }
+/// ...
+/// int32_t watts = load.realPower();       // counts x counts
+/// int16_t pf = load.powerFactor();        // per mille
+/// ...
+/// \endcode
+class ADS7828Power : public ADS7828Accumulator
+{
+  public:
+    // ............................................... public member functions
+    ADS7828Power(ADS7828Channel*, uint16_t);
+    uint16_t currentRms();
+    void newSample(uint16_t);
+    int16_t powerFactor();
+    int32_t realPower();
+    void reset();
+    uint16_t voltageRms();
+
+  private:
+    // .................................................... private attributes
+    /// Quantity of sample pairs accumulated in current window.
+    uint16_t count_;
+
+    /// Current RMS of most-recent complete window.
+    uint16_t currentRms_;
+
+    /// Real power of most-recent complete window.
+    int32_t realPower_;
+
+    /// Sum of current samples in current window.
+    uint32_t sumCurrent_;
+
+    /// Sum of squared current samples in current window.
+    uint64_t sumCurrentSquares_;
+
+    /// Sum of voltage x current products in current window.
+    uint64_t sumProducts_;
+
+    /// Sum of voltage samples in current window.
+    uint32_t sumVoltage_;
+
+    /// Sum of squared voltage samples in current window.
+    uint64_t sumVoltageSquares_;
+
+    /// Voltage channel paired with attached (current) channel.
+    ADS7828Channel* voltage_;
+
+    /// Voltage RMS of most-recent complete window.
+    uint16_t voltageRms_;
+
+    /// Quantity of sample pairs per window.
+    uint16_t window_;
+};
+
+
+/// Goertzel single-frequency detector: amplitude of one tone (e.g. 50/60 Hz
+///   ripple, vibration) per block of samples, without an FFT.
+/// The target frequency is rounded to the nearest bin (sampleRate /
+///   blockSize resolution); the resonator coefficient is precomputed in
+///   fixed point (Q30) so per-sample work is one multiply and two adds.
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0, SINGLE_ENDED | REFERENCE_ON | ADC_ON);
+/// // 120 Hz ripple, channel scanned at 1000 samples/s, 250-sample blocks
+/// ADS7828Goertzel ripple(120, 1000, 250);
+/// ...
+/// void setup()
+/// {
+///   adc.channel(2)->attach(&ripple);
+/// }
+/// ...
+/// uint16_t amplitude = ripple.magnitude();
+/// ...
+/// \endcode
+class ADS7828Goertzel : public ADS7828Accumulator
+{
+  public:
+    // ............................................... public member functions
+    ADS7828Goertzel(uint16_t, uint16_t, uint16_t);
+    uint16_t blocks();
+    uint16_t magnitude();
+    void newSample(uint16_t);
+    void reset();
+
+  private:
+    // .................................................... private attributes
+    /// Quantity of completed blocks (wraps).
+    uint16_t blocks_;
+
+    /// Quantity of samples per block.
+    uint16_t blockSize_;
+
+    /// Resonator coefficient 2cos(2 pi k / N) (Q30).
+    int32_t coefficient_;
+
+    /// Quantity of samples accumulated in current block.
+    uint16_t count_;
+
+    /// Tone amplitude of most-recent complete block.
+    uint16_t magnitude_;
+
+    /// Resonator state s[n-1].
+    int32_t s1_;
+
+    /// Resonator state s[n-2].
+    int32_t s2_;
+
+    // ............................................. static private attributes
+    /// Fixed-point fraction bits of \ref coefficient_.
+    static const uint8_t COEFFICIENT_BITS_ = 30;
+};
+
+
+/// Streaming minimum, maximum, mean, and variance of one channel in
+///   constant memory (Welford's method, fixed-point accumulators).
+/// With a non-zero window, statistics restart automatically on the sample
+///   following a full window, so results always describe at most one
+///   window; reset() restarts them at any time.
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0);
+/// ADS7828Statistics noise(1000); // 1000-sample windows
+/// ...
+/// void setup()
+/// {
+///   adc.channel(4)->attach(&noise);
+/// }
+/// ...
+/// if (noise.standardDeviation() > 2.0) { ... }
+/// ...
+/// \endcode
+class ADS7828Statistics : public ADS7828Accumulator
+{
+  public:
+    // ............................................... public member functions
+    ADS7828Statistics(uint16_t);
+    uint16_t count();
+    uint16_t maximum();
+    float mean();
+    uint16_t minimum();
+    void newSample(uint16_t);
+    void reset();
+    float standardDeviation();
+    float variance();
+
+  private:
+    // .................................................... private attributes
+    /// Quantity of samples accumulated.
+    uint16_t count_;
+
+    /// Largest sample accumulated.
+    uint16_t maximum_;
+
+    /// Running mean (Q16 fixed point).
+    int32_t mean_;
+
+    /// Smallest sample accumulated.
+    uint16_t minimum_;
+
+    /// Running sum of squared deviations from mean (Q16 fixed point).
+    uint64_t squares_;
+
+    /// Quantity of samples per window (0 = unbounded).
+    uint16_t window_;
+
+    // ............................................. static private attributes
+    /// Fixed-point fraction bits of \ref mean_ and \ref squares_.
+    static const uint8_t FRACTION_BITS_ = 16;
+};
+
+
+/// Minimum/average/maximum of one history slot (unscaled).
+/// \relates ADS7828History
+struct ADS7828Rollup
+{
+  /// Smallest sample in slot.
+  uint16_t minimum;
+
+  /// Average of samples in slot.
+  uint16_t average;
+
+  /// Largest sample in slot.
+  uint16_t maximum;
+};
+
+
+/// Multi-resolution round-robin history of one channel.
+/// Tier 0 stores one ADS7828Rollup per \c samplesPerSlot samples; each
+///   higher tier stores one rollup per \c factor slots of the tier below.
+///   Each tier keeps its \c SLOTS most-recent rollups. Update cost is
+///   constant per sample and RAM is fixed at compile time
+///   (\c TIERS x (\c SLOTS x 6 + 12) bytes plus a few bytes overhead).
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828 adc(0);
+/// // channel scanned 10x per second: per-second, per-minute, per-hour
+/// // tiers, 60 slots each
+/// ADS7828History<3, 60> trend(10, 60);
+/// ADS7828Rollup minutes[60];
+/// ...
+/// void setup()
+/// {
+///   adc.channel(0)->attach(&trend);
+/// }
+/// ...
+/// uint8_t quantity = trend.history(1, minutes, 60); // oldest first
+/// ...
+/// \endcode
+template <uint8_t TIERS, uint8_t SLOTS>
+class ADS7828History : public ADS7828Accumulator
+{
+  public:
+    // ............................................... public member functions
+    /// Constructor.
+    /// \param samplesPerSlot quantity of samples per tier 0 slot (1..65535)
+    /// \param factor quantity of slots per slot of the next tier (1..65535)
+    ADS7828History(uint16_t samplesPerSlot, uint16_t factor)
+    {
+      this->samplesPerSlot_ = (0 == samplesPerSlot) ? 1 : samplesPerSlot;
+      this->factor_ = (0 == factor) ? 1 : factor;
+      reset();
+    }
+
+    /// Return quantity of rollups stored in tier.
+    /// \param tier tier (0..TIERS - 1)
+    /// \return quantity (0..SLOTS)
+    uint8_t available(uint8_t tier)
+    {
+      return (tier < TIERS) ? tiers_[tier].filled : 0;
+    }
+
+    /// Copy stored rollups of tier, oldest first.
+    /// \param tier tier (0..TIERS - 1)
+    /// \param buffer destination
+    /// \param quantity capacity of buffer; the most-recent rollups are
+    ///   copied if fewer than available()
+    /// \return quantity copied
+    uint8_t history(uint8_t tier, ADS7828Rollup* buffer, uint8_t quantity)
+    {
+      if (tier >= TIERS) return 0;
+      Tier& t = tiers_[tier];
+      if (quantity > t.filled) quantity = t.filled;
+      uint8_t k, slot = (t.head + SLOTS - quantity) % SLOTS;
+      for (k = 0; k < quantity; k++)
+      {
+        buffer[k] = slots_[tier][slot];
+        slot = (slot + 1) % SLOTS;
+      }
+      return quantity;
+    }
+
+    /// Accumulate sample into tier 0; cascade completed slots upward.
+    /// \param sample sample value (0x0000..0x0FFF)
+    /// \remark Invoked by ADS7828Channel::newSample();
+    ///   this function will not normally be called by end user.
+    void newSample(uint16_t sample)
+    {
+      ADS7828Rollup r = { sample, sample, sample };
+      uint16_t limit = samplesPerSlot_;
+      for (uint8_t tier = 0; tier < TIERS; tier++, limit = factor_)
+      {
+        Tier& t = tiers_[tier];
+        if (r.minimum < t.minimum) t.minimum = r.minimum;
+        if (r.maximum > t.maximum) t.maximum = r.maximum;
+        t.sum += r.average;
+        if (++t.count < limit) return;
+
+        r.minimum = t.minimum;
+        r.average = t.sum / t.count;
+        r.maximum = t.maximum;
+        slots_[tier][t.head] = r;
+        t.head = (t.head + 1) % SLOTS;
+        if (t.filled < SLOTS) t.filled++;
+        clear(t);
+      }
+    }
+
+    /// Discard all stored rollups and partial slots.
+    void reset()
+    {
+      for (uint8_t tier = 0; tier < TIERS; tier++)
+      {
+        clear(tiers_[tier]);
+        tiers_[tier].head = tiers_[tier].filled = 0;
+      }
+    }
+
+  private:
+    // ................................................................ types
+    /// Partial slot and ring position of one tier.
+    struct Tier
+    {
+      uint16_t count;   ///< quantity of inputs in partial slot
+      uint8_t filled;   ///< quantity of rollups stored
+      uint8_t head;     ///< next slot to be written
+      uint16_t maximum; ///< largest input in partial slot
+      uint16_t minimum; ///< smallest input in partial slot
+      uint32_t sum;     ///< sum of inputs in partial slot
+    };
+
+    // .............................................. private member functions
+    /// Empty partial slot of tier.
+    void clear(Tier& t)
+    {
+      t.count = t.maximum = 0;
+      t.minimum = 0xFFFF;
+      t.sum = 0;
+    }
+
+    // .................................................... private attributes
+    /// Quantity of slots per slot of the next tier.
+    uint16_t factor_;
+
+    /// Quantity of samples per tier 0 slot.
+    uint16_t samplesPerSlot_;
+
+    /// Ring of rollups per tier.
+    ADS7828Rollup slots_[TIERS][SLOTS];
+
+    /// Partial slot and ring position per tier.
+    Tier tiers_[TIERS];
+};
+
+
+/// Encode most-recent (unscaled) samples of one or more devices into compact
+///   framed binary telemetry packets; decode with ADS7828Decoder.
+/// Frame layout:
+/// \arg byte 0: \ref SYNC
+/// \arg byte 1: bit 7 set for key frame; bits 3..0 bitmap of device
+///   addresses present
+/// \arg byte 2: sequence number (wraps)
+/// \arg per device present, in address order: channel mask byte (from
+///   ADS7828::channelMask), bit width byte \c w, then one \c w-bit field
+///   per channel present (MSB first, padded to a byte boundary)
+/// \arg last 2 bytes: CRC-16/CCITT (big-endian) over bytes 1..n-3
+///
+/// Key frames carry raw 12-bit samples (\c w = 12). Other frames carry
+///   zigzag-encoded deltas against the previous frame, packed at the
+///   smallest width that fits every delta of the device (0..13 bits). A key
+///   frame is sent first, every \c keyInterval frames, and whenever the
+///   device bitmap or a channel mask changes.
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828Encoder encoder(32);
+/// uint8_t frame[ADS7828Encoder::MAX_FRAME_SIZE];
+/// ...
+/// void loop()
+/// {
+///   ADS7828::updateAll();
+///   Serial.write(frame, encoder.encodeAll(frame));
+/// }
+/// ...
+/// \endcode
+class ADS7828Encoder
+{
+  public:
+    // ............................................... public member functions
+    ADS7828Encoder(uint8_t);
+    uint8_t encode(ADS7828*, uint8_t*);
+    uint8_t encodeAll(uint8_t*);
+    void reset();
+
+    // .............................................. static public attributes
+    /// First byte of every frame.
+    static const uint8_t SYNC = 0xA7;
+
+    /// Largest possible frame (4 devices, 8 channels, 13-bit deltas).
+    static const uint8_t MAX_FRAME_SIZE = 3 + 4 * (2 + 13) + 2;
+
+  private:
+    // .............................................. private member functions
+    uint8_t encode(ADS7828**, uint8_t, uint8_t*);
+
+    // .................................................... private attributes
+    /// Bitmap of device addresses in previous frame.
+    uint8_t devices_;
+
+    /// Frames between key frames.
+    uint8_t keyInterval_;
+
+    /// Channel masks of devices in previous frame.
+    uint8_t masks_[4];
+
+    /// Samples sent in previous frame.
+    uint16_t previous_[4][8];
+
+    /// Sequence number of next frame.
+    uint8_t sequence_;
+
+    /// Frames sent since most-recent key frame.
+    uint8_t sinceKey_;
+};
+
+
+/// Decode frames produced by ADS7828Encoder (e.g. on a host receiving
+///   telemetry).
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828Decoder decoder;
+/// if (0 == decoder.decode(frame, length))
+/// {
+///   uint16_t v = decoder.value(1, 3); // device 1, channel 3
+/// }
+/// ...
+/// \endcode
+class ADS7828Decoder
+{
+  public:
+    // ............................................... public member functions
+    ADS7828Decoder();
+    uint8_t channelMask(uint8_t);
+    uint8_t decode(const uint8_t*, uint8_t);
+    uint8_t devices();
+    void reset();
+    uint8_t sequence();
+    uint16_t value(uint8_t, uint8_t);
+
+  private:
+    // .................................................... private attributes
+    /// Bitmap of device addresses in most-recent frame.
+    uint8_t devices_;
+
+    /// Channel masks of devices in most-recent frame.
+    uint8_t masks_[4];
+
+    /// Sequence number of most-recent frame.
+    uint8_t sequence_;
+
+    /// True once a key frame has been decoded without a subsequent gap.
+    bool synced_;
+
+    /// Samples of most-recent frame.
+    uint16_t values_[4][8];
 };
 #endif
 /// \example examples/one_device/one_device.ino
@@ -0,0 +1,202 @@
+/*
+
+  i2c_adc_ads7828_acquisition.cpp - per-bus acquisition threads for Linux
+
+  Library:: i2c_adc_ads7828
+  Author:: Doc Walker <4-20ma@wvfans.net>
+
+  Copyright:: 2009-2016 Doc Walker
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+*/
+
+
+// compiled only for Linux hosts
+#if !defined(ARDUINO) && defined(__linux__)
+
+// _________________________________________________________ STANDARD INCLUDES
+#include <time.h>
+
+
+// __________________________________________________________ PROJECT INCLUDES
+#include "i2c_adc_ads7828_acquisition.h"
+#include "i2c_adc_ads7828_wiring.h"
+
+
+// _________________________________________________________ PRIVATE FUNCTIONS
+/// Return 64-bit monotonic time (microseconds).
+static uint64_t now()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t) t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
+
+// ___________________________________________________ PUBLIC MEMBER FUNCTIONS
+/// Constructor; no buses, not running.
+ADS7828Acquisition::ADS7828Acquisition()
+{
+  this->buses_ = 0;
+  this->period_ = 0;
+  this->running_ = false;
+}
+
+
+/// Destructor; stops workers.
+ADS7828Acquisition::~ADS7828Acquisition()
+{
+  stop();
+}
+
+
+/// Add I2C bus; a worker thread is started for it by start().
+/// \param wire I2C bus (opened via TwoWire::begin())
+/// \return bus index (0..\ref MAX_BUSES - 1), or -1 if full or running
+int8_t ADS7828Acquisition::addBus(TwoWire* wire)
+{
+  if (running_ || buses_ >= MAX_BUSES) return -1;
+  Worker* worker = &workers_[buses_];
+  worker->count = 0;
+  worker->dropped = worker->errors = worker->sweeps = 0;
+  worker->wire = wire;
+  return buses_++;
+}
+
+
+/// Assign device to bus; sets ADS7828::bus.
+/// \param bus bus index returned by addBus()
+/// \param device device object
+/// \retval true device added
+/// \retval false invalid bus, bus full (4 devices), or running
+bool ADS7828Acquisition::addDevice(uint8_t bus, ADS7828* device)
+{
+  if (running_ || bus >= buses_ || workers_[bus].count >= 4) return false;
+  device->bus = workers_[bus].wire;
+  workers_[bus].devices[workers_[bus].count++] = device;
+  return true;
+}
+
+
+/// Return quantity of samples dropped because bus queue was full.
+/// \param bus bus index returned by addBus()
+uint32_t ADS7828Acquisition::dropped(uint8_t bus)
+{
+  return workers_[bus].dropped;
+}
+
+
+/// Return quantity of device sweeps in which at least one channel failed.
+/// Samples from failed sweeps are not published.
+/// \param bus bus index returned by addBus()
+uint32_t ADS7828Acquisition::errors(uint8_t bus)
+{
+  return workers_[bus].errors;
+}
+
+
+/// Return sample queue for bus; consume from a single application thread.
+/// \param bus bus index returned by addBus()
+ADS7828Acquisition::Queue* ADS7828Acquisition::queue(uint8_t bus)
+{
+  return &workers_[bus].queue;
+}
+
+
+/// Start one worker thread per bus.
+/// \param period minimum interval between sweep starts (microseconds);
+///   0 sweeps continuously
+void ADS7828Acquisition::start(uint32_t period)
+{
+  if (running_) return;
+  this->period_ = period;
+  this->running_ = true;
+  for (uint8_t k = 0; k < buses_; k++)
+  {
+    workers_[k].thread = std::thread(run, this, &workers_[k]);
+  }
+}
+
+
+/// Stop and join worker threads.
+void ADS7828Acquisition::stop()
+{
+  if (!running_) return;
+  this->running_ = false;
+  for (uint8_t k = 0; k < buses_; k++) workers_[k].thread.join();
+}
+
+
+/// Return quantity of completed sweeps (all devices on bus).
+/// \param bus bus index returned by addBus()
+uint32_t ADS7828Acquisition::sweeps(uint8_t bus)
+{
+  return workers_[bus].sweeps;
+}
+
+
+// ___________________________________________ STATIC PRIVATE MEMBER FUNCTIONS
+/// Worker thread body: sweep devices on one bus and publish samples.
+/// \param acquisition owning object
+/// \param worker worker state for bus
+void ADS7828Acquisition::run(ADS7828Acquisition* acquisition, Worker* worker)
+{
+  uint8_t bus = worker - acquisition->workers_;
+  uint64_t next = now();
+  while (acquisition->running_)
+  {
+    for (uint8_t d = 0; d < worker->count; d++)
+    {
+      ADS7828* device = worker->devices[d];
+      uint8_t mask = device->channelMask;
+      uint8_t expected = 0;
+      for (uint8_t ch = 0; ch < 8; ch++) expected += bitRead(mask, ch);
+      if (device->update() != expected)
+      {
+        worker->errors++;
+        continue;
+      }
+
+      ADS7828Sample sample;
+      sample.timestamp = now();
+      sample.bus = bus;
+      sample.address = device->address();
+      for (uint8_t ch = 0; ch < 8; ch++)
+      {
+        if (!bitRead(mask, ch)) continue;
+        sample.channel = ch;
+        sample.value = device->channel(ch)->sample();
+        if (!worker->queue.push(sample)) worker->dropped++;
+      }
+    }
+    worker->sweeps++;
+
+    if (0 == acquisition->period_) continue;
+    next += acquisition->period_;
+    uint64_t t = now();
+    if (next > t)
+    {
+      struct timespec delay;
+      delay.tv_sec = (next - t) / 1000000;
+      delay.tv_nsec = ((next - t) % 1000000) * 1000;
+      nanosleep(&delay, 0);
+    }
+    else
+    {
+      next = t; // overran period; do not try to catch up
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,213 @@
+/// \file
+/// Multi-threaded per-bus acquisition for i2c_adc_ads7828 (Linux).
+/*
+
+  i2c_adc_ads7828_acquisition.h - per-bus acquisition threads for Linux
+
+  Library:: i2c_adc_ads7828
+  Author:: Doc Walker <4-20ma@wvfans.net>
+
+  Copyright:: 2009-2016 Doc Walker
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+*/
+
+
+#ifndef i2c_adc_ads7828_acquisition_h
+#define i2c_adc_ads7828_acquisition_h
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+// _________________________________________________________ STANDARD INCLUDES
+#include <atomic>
+#include <thread>
+
+
+// __________________________________________________________ PROJECT INCLUDES
+#include "i2c_adc_ads7828.h"
+
+
+// _________________________________________________________ CLASS DEFINITIONS
+/// Timestamped (unscaled) sample published by ADS7828Acquisition.
+struct ADS7828Sample
+{
+  /// Monotonic time at end of device sweep (microseconds).
+  uint64_t timestamp;
+
+  /// Sample value (0x0000..0x0FFF).
+  uint16_t value;
+
+  /// Bus index as returned by ADS7828Acquisition::addBus().
+  uint8_t bus;
+
+  /// Device address (0..3).
+  uint8_t address;
+
+  /// Channel ID (0..7).
+  uint8_t channel;
+};
+
+
+/// Lock-free single-producer/single-consumer ring of \c SIZE - 1 elements.
+/// push() must only be called from one thread and pop() from one other
+///   thread; neither blocks.
+/// \note \c SIZE must be a power of 2.
+template <typename T, uint16_t SIZE>
+class ADS7828Queue
+{
+  public:
+    // ............................................... public member functions
+    ADS7828Queue() : head_(0), tail_(0) {};
+
+    /// Remove oldest element.
+    /// \param element destination of removed element
+    /// \retval true element removed
+    /// \retval false queue empty
+    bool pop(T& element)
+    {
+      uint16_t tail = tail_.load(std::memory_order_relaxed);
+      if (tail == head_.load(std::memory_order_acquire)) return false;
+      element = elements_[tail];
+      tail_.store((tail + 1) & (SIZE - 1), std::memory_order_release);
+      return true;
+    }
+
+    /// Append element.
+    /// \param element element to append
+    /// \retval true element appended
+    /// \retval false queue full (element dropped)
+    bool push(const T& element)
+    {
+      uint16_t head = head_.load(std::memory_order_relaxed);
+      uint16_t next = (head + 1) & (SIZE - 1);
+      if (next == tail_.load(std::memory_order_acquire)) return false;
+      elements_[head] = element;
+      head_.store(next, std::memory_order_release);
+      return true;
+    }
+
+    /// Return quantity of elements in queue (approximate while in use).
+    uint16_t size()
+    {
+      return (head_.load(std::memory_order_acquire) -
+        tail_.load(std::memory_order_acquire)) & (SIZE - 1);
+    }
+
+  private:
+    // .................................................... private attributes
+    /// Write position; modified by producer only.
+    alignas(64) std::atomic<uint16_t> head_;
+
+    /// Read position; modified by consumer only.
+    alignas(64) std::atomic<uint16_t> tail_;
+
+    /// Ring storage.
+    alignas(64) T elements_[SIZE];
+};
+
+
+/// Runs one worker thread per I2C bus; each worker sweeps its devices via
+///   ADS7828::update() and publishes samples into the bus queue.
+/// Independent adapters are scanned concurrently instead of serially.
+/// \par Usage:
+/// \code
+/// ...
+/// TwoWire bus1, bus2;
+/// ADS7828 adc0(0), adc1(1);
+/// ADS7828Acquisition acquisition;
+///
+/// bus1.begin("/dev/i2c-1");
+/// bus2.begin("/dev/i2c-2");
+/// acquisition.addDevice(acquisition.addBus(&bus1), &adc0);
+/// acquisition.addDevice(acquisition.addBus(&bus2), &adc1);
+/// acquisition.start(1000); // sweep every 1000 us
+///
+/// ADS7828Sample sample;
+/// while (acquisition.queue(0)->pop(sample)) { ... }
+/// ...
+/// acquisition.stop();
+/// ...
+/// \endcode
+class ADS7828Acquisition
+{
+  public:
+    // ................................................................ types
+    /// Per-bus sample queue.
+    typedef ADS7828Queue<ADS7828Sample, 1024> Queue;
+
+    // ............................................... public member functions
+    ADS7828Acquisition();
+    ~ADS7828Acquisition();
+    int8_t addBus(TwoWire*);
+    bool addDevice(uint8_t, ADS7828*);
+    uint32_t dropped(uint8_t);
+    uint32_t errors(uint8_t);
+    Queue* queue(uint8_t);
+    void start(uint32_t);
+    void stop();
+    uint32_t sweeps(uint8_t);
+
+    // .............................................. static public attributes
+    /// Maximum quantity of buses.
+    static const uint8_t MAX_BUSES = 8;
+
+  private:
+    // ................................................................ types
+    /// Worker state for one bus.
+    struct Worker
+    {
+      /// Quantity of devices on bus.
+      uint8_t count;
+
+      /// Devices on bus.
+      ADS7828* devices[4];
+
+      /// Samples dropped because queue was full.
+      std::atomic<uint32_t> dropped;
+
+      /// Sweeps in which at least one channel failed.
+      std::atomic<uint32_t> errors;
+
+      /// Samples published to application threads.
+      Queue queue;
+
+      /// Completed sweeps.
+      std::atomic<uint32_t> sweeps;
+
+      /// Worker thread.
+      std::thread thread;
+
+      /// I2C bus.
+      TwoWire* wire;
+    };
+
+    // ....................................... static private member functions
+    static void run(ADS7828Acquisition*, Worker*);
+
+    // .................................................... private attributes
+    /// Quantity of buses.
+    uint8_t buses_;
+
+    /// Minimum interval between sweep starts (microseconds; 0 = continuous).
+    uint32_t period_;
+
+    /// True while workers are running.
+    std::atomic<bool> running_;
+
+    /// Per-bus worker state.
+    Worker workers_[MAX_BUSES];
+};
+
+#endif
+#endif
@@ -0,0 +1,535 @@
+/*
+
+  i2c_adc_ads7828_linux.cpp - Linux userspace backend for i2c_adc_ads7828
+
+  Library:: i2c_adc_ads7828
+  Author:: Doc Walker <4-20ma@wvfans.net>
+
+  Copyright:: 2009-2016 Doc Walker
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+*/
+
+
+// compiled only for Linux hosts; Arduino builds use the core Wire library
+#if !defined(ARDUINO) && defined(__linux__)
+
+// _________________________________________________________ STANDARD INCLUDES
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+
+// __________________________________________________________ PROJECT INCLUDES
+#include "i2c_adc_ads7828_linux.h"
+#include "i2c_adc_ads7828_wiring.h"
+
+
+// _________________________________________________________________ FUNCTIONS
+namespace ads7828_wiring
+{
+/// Suspend calling thread (Wiring core API).
+/// \param ms duration (milliseconds)
+void delay(unsigned long ms)
+{
+  struct timespec duration;
+  duration.tv_sec = ms / 1000;
+  duration.tv_nsec = (ms % 1000) * 1000000L;
+  nanosleep(&duration, 0);
+}
+
+
+/// Re-map a number from one range to another (Wiring core API).
+long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+
+/// Return microseconds elapsed on the monotonic clock (Wiring core API).
+/// Wraps at 32 bits like the Arduino core, which callers' unsigned
+///   interval arithmetic relies on.
+unsigned long micros()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t) (now.tv_sec * 1000000UL + now.tv_nsec / 1000);
+}
+
+
+/// Return milliseconds elapsed on the monotonic clock (Wiring core API).
+/// Wraps at 32 bits like the Arduino core.
+unsigned long millis()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t) (now.tv_sec * 1000UL + now.tv_nsec / 1000000);
+}
+
+
+/// Combine high and low bytes into a word (Wiring core API).
+uint16_t word(uint8_t high, uint8_t low)
+{
+  return (high << 8) | low;
+}
+}
+
+
+// ___________________________________________________ PUBLIC MEMBER FUNCTIONS
+/// Write bytes one at a time via write(uint8_t).
+/// \return quantity of bytes written
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+  size_t n = 0;
+  while (size--) n += write(*buffer++);
+  return n;
+}
+
+
+// ___________________________________________________ PUBLIC MEMBER FUNCTIONS
+/// Forward to \c close() system call.
+int ADS7828LinuxIo::close(int fd)
+{
+  return ::close(fd);
+}
+
+
+/// Forward to \c ioctl() system call.
+int ADS7828LinuxIo::ioctl(int fd, unsigned long request, void* arg)
+{
+  return ::ioctl(fd, request, arg);
+}
+
+
+/// Forward to \c open() system call.
+int ADS7828LinuxIo::open(const char* path, int flags)
+{
+  return ::open(path, flags);
+}
+
+
+// _____________________________________________________ PRIVATE GLOBAL OBJECTS
+/// File-descriptor layer used unless replaced via TwoWire::setIo().
+static ADS7828LinuxIo systemIo;
+
+
+// ___________________________________________________ PUBLIC MEMBER FUNCTIONS
+/// Constructor; adapter is opened by begin().
+TwoWire::TwoWire()
+{
+  this->fd_ = -1;
+  this->io_ = &systemIo;
+  this->pending_ = false;
+  this->rxIndex_ = this->rxLength_ = this->txLength_ = 0;
+}
+
+
+/// Return quantity of received bytes remaining to be read().
+int TwoWire::available()
+{
+  return rxLength_ - rxIndex_;
+}
+
+
+/// Open \ref DEFAULT_DEVICE.
+void TwoWire::begin()
+{
+  begin(DEFAULT_DEVICE);
+}
+
+
+/// \overload void TwoWire::begin(const char* device)
+/// \param device adapter path, e.g. "/dev/i2c-0"
+/// \par Usage:
+/// \code
+/// ...
+/// Wire.begin("/dev/i2c-3");
+/// ...
+/// \endcode
+void TwoWire::begin(const char* device)
+{
+  end();
+  this->fd_ = io_->open(device, O_RDWR);
+}
+
+
+/// Begin buffering a write transaction to slave.
+/// \param address 7-bit slave address
+void TwoWire::beginTransmission(uint8_t address)
+{
+  this->address_ = address;
+  this->txLength_ = 0;
+}
+
+
+/// Close adapter.
+void TwoWire::end()
+{
+  if (fd_ >= 0) io_->close(fd_);
+  this->fd_ = -1;
+  this->pending_ = false;
+}
+
+
+/// Transmit buffered write transaction followed by STOP.
+/// \retval 0 success
+/// \retval 1 length too long for buffer
+/// \retval 2 address send, NACK received
+/// \retval 4 other error (adapter not open, bus error, ...)
+uint8_t TwoWire::endTransmission()
+{
+  return endTransmission(true);
+}
+
+
+/// \overload uint8_t TwoWire::endTransmission(uint8_t sendStop)
+/// \param sendStop if false, the write is held and issued with the next
+///   transaction as a single combined (repeated START) transfer
+uint8_t TwoWire::endTransmission(uint8_t sendStop)
+{
+  uint8_t status = 0;
+  if (!sendStop)
+  {
+    if (pending_) status = transfer(0, 0);
+    for (uint8_t k = 0; k < txLength_; k++)
+    {
+      this->pendingBuffer_[k] = txBuffer_[k];
+    }
+    this->pendingAddress_ = address_;
+    this->pendingLength_ = txLength_;
+    this->pending_ = true;
+    return status;
+  }
+
+  struct i2c_msg message;
+  message.addr = address_;
+  message.flags = 0;
+  message.len = txLength_;
+  message.buf = txBuffer_;
+  return transfer(&message, 1);
+}
+
+
+/// Return next received byte.
+/// \return byte value (0..255) or -1 if none remain
+int TwoWire::read()
+{
+  if (rxIndex_ >= rxLength_) return -1;
+  return rxBuffer_[rxIndex_++];
+}
+
+
+/// Read bytes from slave into receive buffer.
+/// \param address 7-bit slave address
+/// \param quantity quantity of bytes (1..32)
+/// \return quantity of bytes received (0 on error)
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity)
+{
+  return requestFrom(address, quantity, true);
+}
+
+
+/// \overload uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop)
+/// \param sendStop ignored; a read always completes the transfer so the
+///   data can be returned
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity,
+  uint8_t sendStop)
+{
+  (void) sendStop;
+  if (quantity > BUFFER_LENGTH_) quantity = BUFFER_LENGTH_;
+  struct i2c_msg message;
+  message.addr = address;
+  message.flags = I2C_M_RD;
+  message.len = quantity;
+  message.buf = rxBuffer_;
+  this->rxIndex_ = 0;
+  this->rxLength_ = (0 == transfer(&message, 1)) ? quantity : 0;
+  return rxLength_;
+}
+
+
+/// Bus clock is fixed by the adapter driver (device tree or module
+///   parameter) and cannot be changed from userspace; no effect.
+void TwoWire::setClock(uint32_t clock)
+{
+  (void) clock;
+}
+
+
+/// Replace file-descriptor layer; takes effect on next begin().
+/// \param io file-descriptor layer, or 0 to restore system calls
+void TwoWire::setIo(ADS7828LinuxIo* io)
+{
+  end();
+  this->io_ = (0 == io) ? &systemIo : io;
+}
+
+
+/// Issue command byte / 2-byte read pairs to a slave in a single ioctl.
+/// \param address 7-bit slave address
+/// \param commands command bytes, one per conversion
+/// \param quantity quantity of command bytes (0..8)
+/// \param results destination of 16-bit (big-endian on the wire) results
+/// \retval 0 success; all results valid
+/// \retval 1 too many commands
+/// \retval 2 address send, NACK received
+/// \retval 4 other error (adapter not open, bus error, ...)
+uint8_t TwoWire::sweep(uint8_t address, const uint8_t* commands,
+  uint8_t quantity, uint16_t* results)
+{
+  struct i2c_msg messages[16];
+  uint8_t data[16];
+  uint8_t k, status;
+
+  if (quantity > 8) return 1;
+  for (k = 0; k < quantity; k++)
+  {
+    messages[2 * k].addr = address;
+    messages[2 * k].flags = 0;
+    messages[2 * k].len = 1;
+    messages[2 * k].buf = const_cast<uint8_t*>(&commands[k]);
+    messages[2 * k + 1].addr = address;
+    messages[2 * k + 1].flags = I2C_M_RD;
+    messages[2 * k + 1].len = 2;
+    messages[2 * k + 1].buf = &data[2 * k];
+  }
+  status = transfer(messages, 2 * quantity);
+  if (0 != status) return status;
+  for (k = 0; k < quantity; k++)
+  {
+    results[k] = word(data[2 * k], data[2 * k + 1]);
+  }
+  return 0;
+}
+
+
+/// Issue messages (preceded by any pending write) in a single I2C_RDWR ioctl.
+/// \param messages array of messages
+/// \param quantity quantity of messages
+/// \retval 0 success
+/// \retval 1 too many messages
+/// \retval 2 address send, NACK received
+/// \retval 4 other error (adapter not open, bus error, ...)
+uint8_t TwoWire::transfer(struct i2c_msg* messages, uint8_t quantity)
+{
+  struct i2c_msg combined[MAX_MESSAGES_];
+  struct i2c_rdwr_ioctl_data data;
+  uint8_t k, n = 0;
+
+  if (pending_)
+  {
+    combined[n].addr = pendingAddress_;
+    combined[n].flags = 0;
+    combined[n].len = pendingLength_;
+    combined[n].buf = pendingBuffer_;
+    n++;
+    this->pending_ = false;
+  }
+  if (quantity > MAX_MESSAGES_ - n) return 1;
+  for (k = 0; k < quantity; k++) combined[n++] = messages[k];
+  if (0 == n) return 0;
+  if (fd_ < 0) return 4;
+
+  data.msgs = combined;
+  data.nmsgs = n;
+  if (io_->ioctl(fd_, I2C_RDWR, &data) < 0)
+  {
+    return (ENXIO == errno || EREMOTEIO == errno) ? 2 : 4;
+  }
+  return 0;
+}
+
+
+/// Append byte to transmit buffer.
+/// \return quantity of bytes buffered (0 if buffer full)
+size_t TwoWire::write(uint8_t data)
+{
+  if (txLength_ >= BUFFER_LENGTH_) return 0;
+  this->txBuffer_[txLength_++] = data;
+  return 1;
+}
+
+
+// ___________________________________________________ PUBLIC MEMBER FUNCTIONS
+/// Constructor; no trace loaded.
+ADS7828Replay::ADS7828Replay()
+{
+  this->data_ = 0;
+  this->length_ = this->position_ = 0;
+  this->mismatches_ = 0;
+}
+
+
+/// Destructor; unmaps trace.
+ADS7828Replay::~ADS7828Replay()
+{
+  unload();
+}
+
+
+/// No adapter to close.
+int ADS7828Replay::close(int fd)
+{
+  (void) fd;
+  return 0;
+}
+
+
+/// Return whether every record of the trace has been replayed.
+bool ADS7828Replay::finished()
+{
+  return position_ >= length_;
+}
+
+
+/// Serve an I2C_RDWR transfer from the trace.
+/// A batched transfer is all-or-nothing: if any command record carries a
+///   non-zero status, no records are consumed, so the per-channel retry
+///   issued by ADS7828::update() replays the same records as the capture.
+///   Address-only transactions (ADS7828::discover()) consume a probe record
+///   and reproduce its status; a trace without one acknowledges and counts
+///   a mismatch, as does a record for a different device address.
+/// \return 0 on success, -1 with \c errno set on failure or end of trace
+int ADS7828Replay::ioctl(int fd, unsigned long request, void* arg)
+{
+  (void) fd;
+  if (I2C_RDWR != request)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  struct i2c_rdwr_ioctl_data* data = (struct i2c_rdwr_ioctl_data*) arg;
+  size_t position = position_;
+  uint32_t mismatches = 0;
+  for (uint32_t k = 0; k < data->nmsgs; k++)
+  {
+    struct i2c_msg* message = &data->msgs[k];
+    bool result = (message->flags & I2C_M_RD);
+    bool probe = !result && 0 == message->len;
+    bool probed = position + 3 <= length_ &&
+      PROBE_ == (data_[position] & (RESULT_ | PROBE_));
+    if (probe && !probed)
+    {
+      mismatches++; // trace recorded without this probe
+      continue;
+    }
+    size_t size = probe ? 3 : (result ? 5 : 4);
+    if (position + size > length_ || probed != probe ||
+      result != (0 != (data_[position] & RESULT_)))
+    {
+      errno = EIO;
+      return -1;
+    }
+    if ((data_[position] & 0x03) != (message->addr & 0x03)) mismatches++;
+    if (result)
+    {
+      message->buf[0] = data_[position + 3];
+      if (message->len > 1) message->buf[1] = data_[position + 4];
+    }
+    else
+    {
+      uint8_t status = (data_[position] >> 4) & 0x07;
+      if (0 != status)
+      {
+        // a failed single command consumes its record; a failed batch
+        //   consumes nothing and is retried channel by channel
+        if (1 == data->nmsgs) this->position_ = position + size;
+        this->mismatches_ += mismatches;
+        errno = (2 == status) ? ENXIO : EIO;
+        return -1;
+      }
+      if (!probe && message->buf[0] != data_[position + 3]) mismatches++;
+    }
+    position += size;
+  }
+  this->position_ = position;
+  this->mismatches_ += mismatches;
+  return 0;
+}
+
+
+/// Memory-map trace file and rewind.
+/// \param path trace file written via ADS7828::record()
+/// \retval true trace loaded
+/// \retval false file could not be opened/mapped
+bool ADS7828Replay::load(const char* path)
+{
+  unload();
+  int fd = ::open(path, O_RDONLY);
+  if (fd < 0) return false;
+  struct stat info;
+  if (0 == fstat(fd, &info) && info.st_size > 0)
+  {
+    void* map = mmap(0, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (MAP_FAILED != map)
+    {
+      this->data_ = (const uint8_t*) map;
+      this->length_ = info.st_size;
+    }
+  }
+  ::close(fd);
+  rewind();
+  return 0 != data_;
+}
+
+
+/// Return quantity of transactions that differed from the trace (command
+///   byte or device address, e.g. replaying with a different scan order or
+///   channel mask), plus probes the trace has no record of.
+uint32_t ADS7828Replay::mismatches()
+{
+  return mismatches_;
+}
+
+
+/// No adapter to open; any path succeeds.
+int ADS7828Replay::open(const char* path, int flags)
+{
+  (void) path;
+  (void) flags;
+  return 0;
+}
+
+
+/// Restart replay from first record.
+void ADS7828Replay::rewind()
+{
+  this->position_ = 0;
+  this->mismatches_ = 0;
+}
+
+
+// __________________________________________________ PRIVATE MEMBER FUNCTIONS
+/// Unmap trace.
+void ADS7828Replay::unload()
+{
+  if (0 != data_) munmap((void*) data_, length_);
+  this->data_ = 0;
+  this->length_ = 0;
+}
+
+
+// _________________________________________________ STATIC PUBLIC ATTRIBUTES
+const char* const TwoWire::DEFAULT_DEVICE = "/dev/i2c-1";
+
+
+// ____________________________________________________________ GLOBAL OBJECTS
+TwoWire Wire;
+
+#endif
@@ -0,0 +1,218 @@
+/// \file
+/// Linux userspace (/dev/i2c-N) backend for i2c_adc_ads7828.
+/*
+
+  i2c_adc_ads7828_linux.h - Linux userspace backend for i2c_adc_ads7828
+
+  Library:: i2c_adc_ads7828
+  Author:: Doc Walker <4-20ma@wvfans.net>
+
+  Copyright:: 2009-2016 Doc Walker
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+*/
+
+
+#ifndef i2c_adc_ads7828_linux_h
+#define i2c_adc_ads7828_linux_h
+
+// _________________________________________________________ STANDARD INCLUDES
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+
+// _________________________________________________________ CLASS DEFINITIONS
+/// Byte sink (Wiring core API subset); used by ADS7828::record().
+class Print
+{
+  public:
+    // ............................................... public member functions
+    virtual ~Print() {};
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t*, size_t);
+};
+
+
+/// File-descriptor layer used by TwoWire to reach /dev/i2c-N.
+/// The default implementation forwards to the \c open(), \c ioctl(), and
+///   \c close() system calls; override it to run against a fake adapter.
+/// \par Usage:
+/// \code
+/// ...
+/// class FakeAdapter : public ADS7828LinuxIo
+/// {
+///   public:
+///     int open(const char*, int) { return 3; }
+///     int ioctl(int, unsigned long, void* arg) { ...; return 0; }
+///     int close(int) { return 0; }
+/// };
+/// FakeAdapter adapter;
+/// Wire.setIo(&adapter);
+/// ADS7828::begin();
+/// ...
+/// \endcode
+class ADS7828LinuxIo
+{
+  public:
+    // ............................................... public member functions
+    virtual ~ADS7828LinuxIo() {};
+    virtual int close(int);
+    virtual int ioctl(int, unsigned long, void*);
+    virtual int open(const char*, int);
+};
+
+
+/// Wire-compatible I2C bus on a Linux /dev/i2c-N adapter.
+/// Transactions are issued with the \c I2C_RDWR ioctl; a write ended without
+///   a STOP condition is held and combined (repeated START) with the next
+///   transaction in a single ioctl.
+class TwoWire
+{
+  public:
+    // ............................................... public member functions
+    TwoWire();
+    int available();
+    void begin();
+    void begin(const char*);
+    void beginTransmission(uint8_t);
+    void end();
+    uint8_t endTransmission();
+    uint8_t endTransmission(uint8_t);
+    int read();
+    uint8_t requestFrom(uint8_t, uint8_t);
+    uint8_t requestFrom(uint8_t, uint8_t, uint8_t);
+    void setClock(uint32_t);
+    void setIo(ADS7828LinuxIo*);
+    uint8_t sweep(uint8_t, const uint8_t*, uint8_t, uint16_t*);
+    uint8_t transfer(struct i2c_msg*, uint8_t);
+    size_t write(uint8_t);
+
+    // ........................................ static public member functions
+
+    // ..................................................... public attributes
+
+    // .............................................. static public attributes
+    /// Default adapter opened by begin().
+    static const char* const DEFAULT_DEVICE;
+
+  private:
+    // .............................................. private member functions
+
+    // ....................................... static private member functions
+
+    // .................................................... private attributes
+    /// Slave address of pending/current transmission.
+    uint8_t address_;
+
+    /// Adapter file descriptor (-1 if not open).
+    int fd_;
+
+    /// File-descriptor layer (system calls or fake adapter).
+    ADS7828LinuxIo* io_;
+
+    /// True if a write was ended without STOP and awaits the next transfer.
+    bool pending_;
+
+    /// Slave address of pending write.
+    uint8_t pendingAddress_;
+
+    /// Pending write data.
+    uint8_t pendingBuffer_[32];
+
+    /// Quantity of bytes in pending write.
+    uint8_t pendingLength_;
+
+    /// Receive buffer filled by requestFrom().
+    uint8_t rxBuffer_[32];
+
+    /// Read position within receive buffer.
+    uint8_t rxIndex_;
+
+    /// Quantity of bytes in receive buffer.
+    uint8_t rxLength_;
+
+    /// Transmit buffer filled by write().
+    uint8_t txBuffer_[32];
+
+    /// Quantity of bytes in transmit buffer.
+    uint8_t txLength_;
+
+    // ............................................. static private attributes
+    /// Size of transmit/receive buffers (matches Arduino Wire).
+    static const uint8_t BUFFER_LENGTH_ = 32;
+
+    /// Maximum messages per I2C_RDWR ioctl (I2C_RDWR_IOCTL_MAX_MSGS).
+    static const uint8_t MAX_MESSAGES_ = 42;
+};
+
+
+/// File-descriptor layer that replays a trace recorded via
+///   ADS7828::record() instead of reaching an adapter.
+/// The trace file is memory-mapped; each command write consumes the next
+///   command record (reproducing its status) and each 2-byte read returns
+///   the next result record, at full speed regardless of recorded timing.
+/// \par Usage:
+/// \code
+/// ...
+/// ADS7828Replay replay;
+/// replay.load("trace.bin");
+/// Wire.setIo(&replay);
+/// ADS7828::begin();
+/// while (!replay.finished()) ADS7828::updateAll();
+/// ...
+/// \endcode
+class ADS7828Replay : public ADS7828LinuxIo
+{
+  public:
+    // ............................................... public member functions
+    ADS7828Replay();
+    ~ADS7828Replay();
+    int close(int);
+    bool finished();
+    int ioctl(int, unsigned long, void*);
+    bool load(const char*);
+    uint32_t mismatches();
+    int open(const char*, int);
+    void rewind();
+
+  private:
+    // .............................................. private member functions
+    void unload();
+
+    // .................................................... private attributes
+    /// Mapped trace (0 if none loaded).
+    const uint8_t* data_;
+
+    /// Trace length (bytes).
+    size_t length_;
+
+    /// Transactions that differed from the trace.
+    uint32_t mismatches_;
+
+    /// Offset of next record.
+    size_t position_;
+
+    // ............................................. static private attributes
+    /// Record tag bit marking a probe (address-only) record.
+    static const uint8_t PROBE_ = 0x08;
+
+    /// Record tag bit marking a result record.
+    static const uint8_t RESULT_ = 0x80;
+};
+
+
+extern TwoWire Wire;
+#endif
@@ -0,0 +1,57 @@
+/// \file
+/// Wiring core API subset used internally by the Linux build.
+/*
+
+  i2c_adc_ads7828_wiring.h - Wiring core API subset for i2c_adc_ads7828
+
+  Library:: i2c_adc_ads7828
+  Author:: Doc Walker <4-20ma@wvfans.net>
+
+  Copyright:: 2009-2016 Doc Walker
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+*/
+
+
+// internal header: included only by the library's .cpp files, so that
+//   host programs do not inherit these names (e.g. map, word, bitRead)
+#ifndef i2c_adc_ads7828_wiring_h
+#define i2c_adc_ads7828_wiring_h
+
+// _________________________________________________________ STANDARD INCLUDES
+#include <math.h>
+#include <stdint.h>
+
+
+// ____________________________________________________________ UTILITY MACROS
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define lowByte(w) ((uint8_t) ((w) & 0xFF))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+#define TWO_PI 6.283185307179586476925286766559
+
+
+// _________________________________________________________________ FUNCTIONS
+namespace ads7828_wiring
+{
+  void delay(unsigned long);
+  long map(long, long, long, long, long);
+  unsigned long micros();
+  unsigned long millis();
+  uint16_t word(uint8_t, uint8_t);
+}
+using namespace ads7828_wiring;
+
+#endif